@@ -0,0 +1,81 @@
+#include <fstream>
+#include "arquivo.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ARQUIVO_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+using namespace std;
+
+ArquivoMapeado::ArquivoMapeado() : dados(nullptr), tamanho(0), mapeado(false) {}
+
+ArquivoMapeado::~ArquivoMapeado() { fechar(); }
+
+bool ArquivoMapeado::abrir(const std::string &arq)
+{
+  fechar();
+
+#ifdef ARQUIVO_MMAP
+  int fd = open(arq.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat info;
+  if (fstat(fd, &info) != 0)
+  {
+    close(fd);
+    return false;
+  }
+  tamanho = info.st_size;
+  if (tamanho > 0)
+  {
+    void *p = mmap(nullptr, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p != MAP_FAILED)
+    {
+      // O arquivo serah lido do inicio ao fim
+      madvise(p, tamanho, MADV_SEQUENTIAL);
+      dados = static_cast<const char *>(p);
+      mapeado = true;
+    }
+  }
+  close(fd);
+  if (mapeado || tamanho == 0)
+    return true;
+  tamanho = 0;
+#endif
+
+  // Nao foi possivel mapear: leh o arquivo inteiro para o buffer
+  ifstream arquivo(arq, ios::binary);
+  if (!arquivo.is_open())
+    return false;
+  arquivo.seekg(0, ios::end);
+  buffer.resize(size_t(arquivo.tellg()));
+  arquivo.seekg(0, ios::beg);
+  arquivo.read(buffer.data(), buffer.size());
+  if (!arquivo.good() && !arquivo.eof())
+  {
+    buffer.clear();
+    return false;
+  }
+  dados = buffer.data();
+  tamanho = buffer.size();
+  return true;
+}
+
+void ArquivoMapeado::fechar()
+{
+#ifdef ARQUIVO_MMAP
+  if (mapeado)
+    munmap(const_cast<char *>(dados), tamanho);
+#endif
+  dados = nullptr;
+  tamanho = 0;
+  mapeado = false;
+  buffer.clear();
+}
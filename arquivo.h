@@ -0,0 +1,50 @@
+#ifndef _ARQUIVO_H_
+#define _ARQUIVO_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+///
+/// CLASSE ARQUIVO MAPEADO
+///
+
+// Da acesso ao conteudo de um arquivo inteiro como um array de bytes, soh para leitura
+// Em sistemas POSIX, o arquivo eh mapeado em memoria (mmap): nao ha copia, e as paginas
+// sao lidas do disco sob demanda. Nos demais sistemas, o arquivo eh lido de uma vez
+// para um buffer.
+class ArquivoMapeado
+{
+private:
+  const char *dados;
+  size_t tamanho;
+  // true se dados aponta para uma area mapeada (que deve ser desmapeada)
+  bool mapeado;
+  // Buffer usado quando nao eh possivel mapear o arquivo
+  std::vector<char> buffer;
+
+public:
+  ArquivoMapeado();
+  // Destrutor: apenas chama a funcao fechar()
+  ~ArquivoMapeado();
+
+  // Nao pode ser copiado
+  ArquivoMapeado(const ArquivoMapeado &) = delete;
+  void operator=(const ArquivoMapeado &) = delete;
+
+  // Abre o arquivo arq (fechando o anterior, se houver)
+  // Retorna true se deu tudo OK; false se deu erro
+  bool abrir(const std::string &arq);
+
+  // Libera o arquivo
+  void fechar();
+
+  // O conteudo do arquivo
+  const char *getDados() const { return dados; }
+  size_t getTamanho() const { return tamanho; }
+};
+
+#endif // _ARQUIVO_H_
@@ -0,0 +1,35 @@
+#include "avaliador.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+using namespace std;
+
+// Converte a sigla de uma porta no TipoPorta correspondente
+bool toTipoPorta(const std::string &Sigla, TipoPorta &T)
+{
+  if (Sigla == "NT")
+    T = TipoPorta::NT;
+  else if (Sigla == "AN")
+    T = TipoPorta::AN;
+  else if (Sigla == "NA")
+    T = TipoPorta::NA;
+  else if (Sigla == "OR")
+    T = TipoPorta::OR;
+  else if (Sigla == "NO")
+    T = TipoPorta::NO;
+  else if (Sigla == "XO")
+    T = TipoPorta::XO;
+  else if (Sigla == "NX")
+    T = TipoPorta::NX;
+  else
+    return false;
+  return true;
+}
+
+// Retorna a sigla de um TipoPorta
+std::string toSigla(TipoPorta T)
+{
+  static const char *sigla[] = {"NT", "AN", "NA", "OR", "NO", "XO", "NX"};
+  return sigla[int(T)];
+}
@@ -0,0 +1,120 @@
+#ifndef _AVALIADOR_H_
+#define _AVALIADOR_H_
+
+#include <cstdint>
+#include <string>
+#include "bool3S.h"
+#include "palavra3S.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// O AVALIADOR DE PORTAS
+/// Calcula a saida de uma porta logica a partir dos valores das suas entradas,
+/// sem funcoes virtuais nem vetores temporarios: o tipo da porta eh um valor
+/// (TipoPorta), e o calculo de cada tipo eh gerado em tempo de compilacao
+/// (template) e escolhido por um unico switch.
+/// Eh usado tanto pela netlist (simulacao) quanto pelas classes Port.
+/// ###########################################################################
+
+// Os tipos de porta logica, na forma compacta usada pela netlist e pelo avaliador
+enum class TipoPorta : uint8_t
+{
+  NT,
+  AN,
+  NA,
+  OR,
+  NO,
+  XO,
+  NX
+};
+
+// Converte a sigla de uma porta (NT, AN, NA, OR, NO, XO, NX) no TipoPorta correspondente
+// Retorna false se a sigla nao for valida
+bool toTipoPorta(const std::string &Sigla, TipoPorta &T);
+// Retorna a sigla (NT, AN, NA, OR, NO, XO, NX) de um TipoPorta
+std::string toSigla(TipoPorta T);
+
+// Calcula a saida de uma porta do tipo T com N entradas, para valores do tipo V
+// (bool3S ou Palavra3S); E(j) retorna o valor da j-esima entrada (j de 0 a N-1)
+// O calculo nao para quando o resultado jah estah decidido (p.ex. um FALSE no AND):
+// com os operadores sem desvios de bool3S, o laco nao tem nenhum desvio que dependa
+// dos valores, o que compensa ler todas as entradas
+template <TipoPorta T, class V, class Entrada>
+inline V avaliarPorta(unsigned N, Entrada E)
+{
+  V S = E(0);
+  if constexpr (T == TipoPorta::NT)
+    return ~S;
+  else if constexpr (T == TipoPorta::AN || T == TipoPorta::NA)
+  {
+    for (unsigned j = 1; j < N; j++)
+      S = S & E(j);
+    return (T == TipoPorta::AN ? S : ~S);
+  }
+  else if constexpr (T == TipoPorta::OR || T == TipoPorta::NO)
+  {
+    for (unsigned j = 1; j < N; j++)
+      S = S | E(j);
+    return (T == TipoPorta::OR ? S : ~S);
+  }
+  else
+  {
+    for (unsigned j = 1; j < N; j++)
+      S = S ^ E(j);
+    return (T == TipoPorta::XO ? S : ~S);
+  }
+}
+
+// Idem, com o tipo da porta conhecido soh durante a execucao
+template <class V, class Entrada>
+inline V avaliarPorta(TipoPorta T, unsigned N, Entrada E)
+{
+  switch (T)
+  {
+  case TipoPorta::NT:
+    return avaliarPorta<TipoPorta::NT, V>(N, E);
+  case TipoPorta::AN:
+    return avaliarPorta<TipoPorta::AN, V>(N, E);
+  case TipoPorta::NA:
+    return avaliarPorta<TipoPorta::NA, V>(N, E);
+  case TipoPorta::OR:
+    return avaliarPorta<TipoPorta::OR, V>(N, E);
+  case TipoPorta::NO:
+    return avaliarPorta<TipoPorta::NO, V>(N, E);
+  case TipoPorta::XO:
+    return avaliarPorta<TipoPorta::XO, V>(N, E);
+  case TipoPorta::NX:
+    return avaliarPorta<TipoPorta::NX, V>(N, E);
+  }
+  // Nunca deve chegar aqui...
+  return avaliarPorta<TipoPorta::NT, V>(1, E);
+}
+
+// Idem, com os valores das N entradas em posicoes consecutivas do array V (N >= 1)
+// Usa as reducoes n-arias da classe bool3S, sem desvios que dependam dos valores
+inline bool3S avaliarPorta(TipoPorta T, const bool3S *V, unsigned N)
+{
+  switch (T)
+  {
+  case TipoPorta::NT:
+    return ~V[0];
+  case TipoPorta::AN:
+    return reduzirAND(V, N);
+  case TipoPorta::NA:
+    return ~reduzirAND(V, N);
+  case TipoPorta::OR:
+    return reduzirOR(V, N);
+  case TipoPorta::NO:
+    return ~reduzirOR(V, N);
+  case TipoPorta::XO:
+    return reduzirXOR(V, N);
+  case TipoPorta::NX:
+    return ~reduzirXOR(V, N);
+  }
+  // Nunca deve chegar aqui...
+  return bool3S::UNDEF;
+}
+
+#endif // _AVALIADOR_H_
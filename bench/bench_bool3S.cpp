@@ -0,0 +1,203 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "bool3S.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// MICRO-BENCHMARK DOS OPERADORES DA CLASSE BOOL3S
+/// Compara os operadores sem desvios (bool3S.h) com a implementacao anterior,
+/// feita com comparacoes e desvios, sobre valores aleatorios (o pior caso para
+/// a previsao de desvios).
+/// Compilacao manual (Google Benchmark):
+///   g++ -std=c++17 -O2 -I.. bench_bool3S.cpp ../bool3S.cpp -lbenchmark -pthread
+/// ###########################################################################
+
+using namespace std;
+
+// A implementacao anterior dos operadores (com desvios), para comparacao
+namespace desvios
+{
+bool3S NOT(bool3S x)
+{
+  if (x == bool3S::UNDEF)
+    return bool3S::UNDEF;
+  if (x == bool3S::TRUE)
+    return bool3S::FALSE;
+  return bool3S::TRUE;
+}
+
+bool3S AND(bool3S x1, bool3S x2)
+{
+  if (x1 == bool3S::FALSE || x2 == bool3S::FALSE)
+    return bool3S::FALSE;
+  if (x1 == bool3S::UNDEF || x2 == bool3S::UNDEF)
+    return bool3S::UNDEF;
+  return bool3S::TRUE;
+}
+
+bool3S OR(bool3S x1, bool3S x2)
+{
+  if (x1 == bool3S::TRUE || x2 == bool3S::TRUE)
+    return bool3S::TRUE;
+  if (x1 == bool3S::UNDEF || x2 == bool3S::UNDEF)
+    return bool3S::UNDEF;
+  return bool3S::FALSE;
+}
+
+bool3S XOR(bool3S x1, bool3S x2)
+{
+  if (x1 == bool3S::UNDEF || x2 == bool3S::UNDEF)
+    return bool3S::UNDEF;
+  if (x1 == x2)
+    return bool3S::FALSE;
+  return bool3S::TRUE;
+}
+} // namespace desvios
+
+// Numero de valores dos arrays usados nos testes
+static const size_t N_VALORES = 1 << 16;
+
+// Array de valores aleatorios (sempre os mesmos)
+static vector<bool3S> aleatorios(unsigned Semente)
+{
+  mt19937 gerador(Semente);
+  vector<bool3S> V(N_VALORES);
+  for (size_t i = 0; i < N_VALORES; i++)
+    V[i] = bool3S(gerador() % 3);
+  return V;
+}
+
+///
+/// Operadores binarios elemento a elemento: R[i] = A[i] op B[i]
+///
+
+// Op eh um functor com a operacao a ser medida (sempre uma lambda: um ponteiro
+// para funcao nao seria expandido inline, e a comparacao seria injusta)
+template <class Op>
+static void medirBinario(benchmark::State &St, Op op)
+{
+  vector<bool3S> A = aleatorios(1), B = aleatorios(2), R(N_VALORES);
+  for (auto _ : St)
+  {
+    for (size_t i = 0; i < N_VALORES; i++)
+      R[i] = op(A[i], B[i]);
+    benchmark::DoNotOptimize(R.data());
+    benchmark::ClobberMemory();
+  }
+  St.SetItemsProcessed(St.iterations() * N_VALORES);
+}
+
+static void BM_AND_Desvios(benchmark::State &St)
+{
+  medirBinario(St, [](bool3S x1, bool3S x2) { return desvios::AND(x1, x2); });
+}
+static void BM_AND_Bits(benchmark::State &St)
+{
+  medirBinario(St, [](bool3S x1, bool3S x2) { return x1 & x2; });
+}
+static void BM_OR_Desvios(benchmark::State &St)
+{
+  medirBinario(St, [](bool3S x1, bool3S x2) { return desvios::OR(x1, x2); });
+}
+static void BM_OR_Bits(benchmark::State &St)
+{
+  medirBinario(St, [](bool3S x1, bool3S x2) { return x1 | x2; });
+}
+static void BM_XOR_Desvios(benchmark::State &St)
+{
+  medirBinario(St, [](bool3S x1, bool3S x2) { return desvios::XOR(x1, x2); });
+}
+static void BM_XOR_Bits(benchmark::State &St)
+{
+  medirBinario(St, [](bool3S x1, bool3S x2) { return x1 ^ x2; });
+}
+static void BM_NAND_Desvios(benchmark::State &St)
+{
+  medirBinario(St, [](bool3S x1, bool3S x2) { return desvios::NOT(desvios::AND(x1, x2)); });
+}
+static void BM_NAND_Bits(benchmark::State &St)
+{
+  medirBinario(St, [](bool3S x1, bool3S x2) { return ~(x1 & x2); });
+}
+static void BM_NOR_Desvios(benchmark::State &St)
+{
+  medirBinario(St, [](bool3S x1, bool3S x2) { return desvios::NOT(desvios::OR(x1, x2)); });
+}
+static void BM_NOR_Bits(benchmark::State &St)
+{
+  medirBinario(St, [](bool3S x1, bool3S x2) { return ~(x1 | x2); });
+}
+static void BM_NXOR_Desvios(benchmark::State &St)
+{
+  medirBinario(St, [](bool3S x1, bool3S x2) { return desvios::NOT(desvios::XOR(x1, x2)); });
+}
+static void BM_NXOR_Bits(benchmark::State &St)
+{
+  medirBinario(St, [](bool3S x1, bool3S x2) { return ~(x1 ^ x2); });
+}
+
+BENCHMARK(BM_AND_Desvios);
+BENCHMARK(BM_AND_Bits);
+BENCHMARK(BM_OR_Desvios);
+BENCHMARK(BM_OR_Bits);
+BENCHMARK(BM_XOR_Desvios);
+BENCHMARK(BM_XOR_Bits);
+BENCHMARK(BM_NAND_Desvios);
+BENCHMARK(BM_NAND_Bits);
+BENCHMARK(BM_NOR_Desvios);
+BENCHMARK(BM_NOR_Bits);
+BENCHMARK(BM_NXOR_Desvios);
+BENCHMARK(BM_NXOR_Bits);
+
+///
+/// Reducoes n-arias: porta de St.range(0) entradas aplicada a todo o array
+///
+
+// Reducao com o operador composto e parada antecipada (como nas antigas Port_*::simular)
+static bool3S reduzirANDDesvios(const bool3S *V, size_t N)
+{
+  bool3S S = V[0];
+  for (size_t j = 1; j < N && S != bool3S::FALSE; j++)
+    S = desvios::AND(S, V[j]);
+  return S;
+}
+static bool3S reduzirXORDesvios(const bool3S *V, size_t N)
+{
+  bool3S S = V[0];
+  for (size_t j = 1; j < N && S != bool3S::UNDEF; j++)
+    S = desvios::XOR(S, V[j]);
+  return S;
+}
+
+// Red eh a funcao de reducao a ser medida
+template <class Red>
+static void medirReducao(benchmark::State &St, Red red)
+{
+  size_t N = St.range(0);
+  vector<bool3S> A = aleatorios(3);
+  vector<bool3S> R(N_VALORES / N);
+  for (auto _ : St)
+  {
+    for (size_t k = 0; k < R.size(); k++)
+      R[k] = red(A.data() + k * N, N);
+    benchmark::DoNotOptimize(R.data());
+    benchmark::ClobberMemory();
+  }
+  St.SetItemsProcessed(St.iterations() * R.size() * N);
+}
+
+static void BM_ReduzirAND_Desvios(benchmark::State &St) { medirReducao(St, reduzirANDDesvios); }
+static void BM_ReduzirAND_Bits(benchmark::State &St) { medirReducao(St, reduzirAND); }
+static void BM_ReduzirXOR_Desvios(benchmark::State &St) { medirReducao(St, reduzirXORDesvios); }
+static void BM_ReduzirXOR_Bits(benchmark::State &St) { medirReducao(St, reduzirXOR); }
+
+BENCHMARK(BM_ReduzirAND_Desvios)->Arg(2)->Arg(4)->Arg(16)->Arg(64);
+BENCHMARK(BM_ReduzirAND_Bits)->Arg(2)->Arg(4)->Arg(16)->Arg(64);
+BENCHMARK(BM_ReduzirXOR_Desvios)->Arg(2)->Arg(4)->Arg(16)->Arg(64);
+BENCHMARK(BM_ReduzirXOR_Bits)->Arg(2)->Arg(4)->Arg(16)->Arg(64);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,230 @@
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "bool3S.h"
+#include "port.h"
+#include "circuito.h"
+#include "tabela.h"
+#include "gerador.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// BENCHMARKS DA LEITURA E DA SIMULACAO DE CIRCUITOS
+/// Mede as operacoes principais sobre circuitos sinteticos (ver gerador.h), que
+/// dependem apenas do tamanho e da semente, para que os resultados possam ser
+/// comparados entre versoes:
+/// - Port_*::simular e Port_*::clone, para cada tipo de porta
+/// - Circuito::ler e Circuito::lerBinario, de 1k a 1M portas
+/// - Circuito::simular, um vetor de entrada por vez
+/// - construtor por copia de Circuito
+/// - geracao da tabela verdade (descartando o texto gerado)
+/// Os operadores de bool3S sao medidos em bench_bool3S.cpp.
+/// Compilacao manual (Google Benchmark):
+///   g++ -std=c++17 -O2 -I.. bench_circuito.cpp <todos os .cpp do projeto, exceto
+///   circuito-main.cpp> -lbenchmark -pthread -ldl
+/// ###########################################################################
+
+using namespace std;
+
+// Semente de todos os circuitos gerados
+static const uint64_t SEMENTE_BENCH = 2024;
+
+// Um circuito sintetico com NP portas (32 entradas e 16 saidas), gerado uma
+// unica vez para cada tamanho
+static const Circuito &circuitoSintetico(unsigned NP)
+{
+  static map<unsigned, unique_ptr<Circuito>> circuitos;
+  unique_ptr<Circuito> &C = circuitos[NP];
+  if (!C)
+  {
+    DescricaoCircuito D;
+    C.reset(new Circuito);
+    gerarCircuito(32, 16, NP, SEMENTE_BENCH, D);
+    C->definir(D);
+    C->compilar();
+  }
+  return *C;
+}
+
+// O arquivo (texto ou binario) com o circuito sintetico de NP portas, gravado no
+// diretorio temporario uma unica vez em cada execucao (sempre regravado, para nao
+// usar um arquivo de uma versao anterior do gerador)
+static string arquivoSintetico(unsigned NP, bool Binario)
+{
+  static set<string> gravados;
+  filesystem::path arq = filesystem::temp_directory_path() /
+                         ("bench_circuito_" + to_string(NP) + (Binario ? ".cbin" : ".txt"));
+  if (gravados.insert(arq.string()).second)
+  {
+    const Circuito &C = circuitoSintetico(NP);
+    if (Binario)
+      C.salvarBinario(arq.string());
+    else
+      C.salvar(arq.string());
+  }
+  return arq.string();
+}
+
+// Vetores de entrada aleatorios (sempre os mesmos) para circuitos de NI entradas
+static vector<vector<bool3S>> vetoresAleatorios(unsigned NI, unsigned N)
+{
+  mt19937 gerador(1);
+  vector<vector<bool3S>> V(N, vector<bool3S>(NI));
+  for (auto &v : V)
+    for (bool3S &x : v)
+      x = bool3S(gerador() % 3);
+  return V;
+}
+
+///
+/// Portas
+///
+
+// Simulacao de uma porta do tipo P com St.range(0) entradas, para vetores aleatorios
+template <class P>
+static void BM_Port_simular(benchmark::State &St)
+{
+  unsigned NI = St.range(0);
+  P porta;
+  porta.setNumInputs(NI);
+  vector<vector<bool3S>> V = vetoresAleatorios(NI, 1024);
+  size_t k = 0;
+  for (auto _ : St)
+  {
+    porta.simular(V[k]);
+    benchmark::DoNotOptimize(porta.getOutput());
+    k = (k + 1) % V.size();
+  }
+  St.SetItemsProcessed(St.iterations());
+}
+
+// Copia de uma porta do tipo P (com 4 entradas, exceto NOT) no heap
+template <class P>
+static void BM_Port_clone(benchmark::State &St)
+{
+  P porta;
+  if (porta.validNumInputs(4))
+    porta.setNumInputs(4);
+  for (unsigned j = 0; j < porta.getNumInputs(); j++)
+    porta.setId_in(j, -int(j + 1));
+  for (auto _ : St)
+  {
+    ptr_Port copia = porta.clone();
+    benchmark::DoNotOptimize(copia);
+    delete copia;
+  }
+  St.SetItemsProcessed(St.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_Port_simular, Port_NOT)->Arg(1);
+BENCHMARK_TEMPLATE(BM_Port_simular, Port_AND)->Arg(2)->Arg(4)->Arg(16);
+BENCHMARK_TEMPLATE(BM_Port_simular, Port_NAND)->Arg(2)->Arg(4)->Arg(16);
+BENCHMARK_TEMPLATE(BM_Port_simular, Port_OR)->Arg(2)->Arg(4)->Arg(16);
+BENCHMARK_TEMPLATE(BM_Port_simular, Port_NOR)->Arg(2)->Arg(4)->Arg(16);
+BENCHMARK_TEMPLATE(BM_Port_simular, Port_XOR)->Arg(2)->Arg(4)->Arg(16);
+BENCHMARK_TEMPLATE(BM_Port_simular, Port_NXOR)->Arg(2)->Arg(4)->Arg(16);
+
+BENCHMARK_TEMPLATE(BM_Port_clone, Port_NOT);
+BENCHMARK_TEMPLATE(BM_Port_clone, Port_AND);
+BENCHMARK_TEMPLATE(BM_Port_clone, Port_XOR);
+
+///
+/// Circuitos: St.range(0) eh o numero de portas
+///
+
+static void BM_Circuito_ler(benchmark::State &St)
+{
+  string arq = arquivoSintetico(St.range(0), false);
+  Circuito C;
+  for (auto _ : St)
+  {
+    if (!C.ler(arq))
+      St.SkipWithError("erro na leitura");
+  }
+  St.SetItemsProcessed(St.iterations() * St.range(0));
+}
+
+static void BM_Circuito_lerBinario(benchmark::State &St)
+{
+  string arq = arquivoSintetico(St.range(0), true);
+  Circuito C;
+  for (auto _ : St)
+  {
+    if (!C.lerBinario(arq))
+      St.SkipWithError("erro na leitura");
+  }
+  St.SetItemsProcessed(St.iterations() * St.range(0));
+}
+
+static void BM_Circuito_copia(benchmark::State &St)
+{
+  const Circuito &C = circuitoSintetico(St.range(0));
+  for (auto _ : St)
+  {
+    Circuito copia(C);
+    benchmark::DoNotOptimize(copia.getNumPorts());
+  }
+  St.SetItemsProcessed(St.iterations() * St.range(0));
+}
+
+// Simulacao de um vetor de entrada por vez (itens: portas simuladas)
+static void BM_Circuito_simular(benchmark::State &St)
+{
+  const Circuito &C = circuitoSintetico(St.range(0));
+  vector<vector<bool3S>> V = vetoresAleatorios(C.getNumInputs(), 64);
+  ContextoSimulacao Ctx;
+  size_t k = 0;
+  for (auto _ : St)
+  {
+    C.simular(V[k], Ctx);
+    benchmark::DoNotOptimize(Ctx.getOutput(1));
+    k = (k + 1) % V.size();
+  }
+  St.SetItemsProcessed(St.iterations() * St.range(0));
+}
+
+BENCHMARK(BM_Circuito_ler)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Circuito_lerBinario)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Circuito_copia)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Circuito_simular)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMicrosecond);
+
+///
+/// Tabela verdade: St.range(0) eh o numero de entradas
+///
+
+// Um streambuf que descarta tudo o que recebe
+class Descarte : public streambuf
+{
+protected:
+  streamsize xsputn(const char *, streamsize N) override { return N; }
+  int overflow(int C) override { return C; }
+};
+
+static void BM_gerarTabela(benchmark::State &St)
+{
+  unsigned NI = St.range(0);
+  DescricaoCircuito D;
+  Circuito C;
+  gerarCircuito(NI, 8, 1000, SEMENTE_BENCH, D);
+  C.definir(D);
+  C.compilar();
+  Descarte descarte;
+  ostream O(&descarte);
+  for (auto _ : St)
+    gerarTabela(C, O, 1);
+  St.SetItemsProcessed(St.iterations() * numLinhasTabela(NI));
+}
+
+BENCHMARK(BM_gerarTabela)->DenseRange(6, 12, 3)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
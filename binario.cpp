@@ -0,0 +1,166 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "binario.h"
+#include "arquivo.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+using namespace std;
+
+uint64_t hashFNV(const void *Dados, size_t N, uint64_t H)
+{
+  const uint64_t PRIMO = 0x100000001b3ULL;
+  const unsigned char *p = static_cast<const unsigned char *>(Dados);
+  size_t i = 0;
+  for (; i + 8 <= N; i += 8)
+  {
+    uint64_t w;
+    memcpy(&w, p + i, 8);
+    H = (H ^ w) * PRIMO;
+  }
+  for (; i < N; i++)
+    H = (H ^ p[i]) * PRIMO;
+  return H;
+}
+
+bool validNetlist(unsigned NI, unsigned NP, const TipoPorta *Tipos, const uint32_t *Inicio,
+                  const int32_t *Id_in, uint64_t Nfanin, unsigned NO, const int32_t *Id_out)
+{
+  if (NI == 0 || NO == 0 || NP == 0 || Inicio[0] != 0 || Inicio[NP] != Nfanin)
+    return false;
+  auto validIdOrig = [&](int32_t Id)
+  { return (Id <= -1 && Id >= -int64_t(NI)) || (Id >= 1 && Id <= int64_t(NP)); };
+
+  for (unsigned i = 0; i < NP; i++)
+  {
+    // Inicio[i+1] <= Nfanin antes de ler as entradas da porta
+    if (uint8_t(Tipos[i]) > uint8_t(TipoPorta::NX) || Inicio[i + 1] < Inicio[i] ||
+        Inicio[i + 1] > Nfanin)
+      return false;
+    uint32_t n = Inicio[i + 1] - Inicio[i];
+    if (Tipos[i] == TipoPorta::NT ? n != 1 : n < 2)
+      return false;
+    for (uint32_t j = Inicio[i]; j < Inicio[i + 1]; j++)
+      if (!validIdOrig(Id_in[j]))
+        return false;
+  }
+  for (unsigned j = 0; j < NO; j++)
+    if (!validIdOrig(Id_out[j]))
+      return false;
+  return true;
+}
+
+// Numero de bytes para completar N ateh um multiplo de M
+static size_t completar(size_t N, size_t M)
+{
+  return (M - N % M) % M;
+}
+
+bool salvarNetlistBinaria(const std::string &arq, const DescricaoCircuito &D)
+{
+  static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+  const vector<TipoPorta> &Tipos = D.tipos;
+  const vector<uint32_t> &Inicio = D.inicio;
+  const vector<int> &Id_in = D.id_in;
+  const vector<int> &Id_out = D.id_out;
+  unsigned NP = Tipos.size();
+  CabecalhoBinario cab;
+
+  memcpy(cab.magica, MAGICA_BINARIO, 8);
+  cab.ordem = ORDEM_BINARIO;
+  cab.versao = VERSAO_BINARIO;
+  cab.Nin = D.Nin;
+  cab.Nout = Id_out.size();
+  cab.Nportas = NP;
+  cab.reservado = 0;
+  cab.Nfanin = Id_in.size();
+
+  // As partes do arquivo depois do cabecalho, na ordem
+  size_t pad_tipo = completar(NP, 4);
+  size_t total = NP + pad_tipo + 4 * (Inicio.size() + Id_in.size() + Id_out.size());
+  size_t pad_final = completar(total, 8);
+  const pair<const void *, size_t> partes[] = {
+      {Tipos.data(), NP},
+      {zeros, pad_tipo},
+      {Inicio.data(), 4 * Inicio.size()},
+      {Id_in.data(), 4 * Id_in.size()},
+      {Id_out.data(), 4 * Id_out.size()},
+      {zeros, pad_final}};
+
+  // O checksum eh calculado sobre o conteudo contiguo, como serah lido
+  string corpo;
+  corpo.reserve(total + pad_final);
+  for (const auto &p : partes)
+    corpo.append(static_cast<const char *>(p.first), p.second);
+  cab.checksum = hashFNV(corpo.data(), corpo.size());
+
+  ofstream arquivo(arq, ios::binary);
+  if (!arquivo.is_open())
+    return false;
+  arquivo.write(reinterpret_cast<const char *>(&cab), sizeof(cab));
+  arquivo.write(corpo.data(), corpo.size());
+  return arquivo.good();
+}
+
+bool lerNetlistBinaria(const std::string &arq, Netlist &N)
+{
+  ArquivoMapeado A;
+  CabecalhoBinario cab;
+
+  N.clear();
+  if (!A.abrir(arq) || A.getTamanho() < sizeof(cab))
+    return false;
+  memcpy(&cab, A.getDados(), sizeof(cab));
+  if (memcmp(cab.magica, MAGICA_BINARIO, 8) != 0)
+  {
+    cerr << "Erro: Arquivo nao estah no formato binario de circuito\n";
+    return false;
+  }
+  if (cab.ordem != ORDEM_BINARIO || cab.versao != VERSAO_BINARIO)
+  {
+    cerr << "Erro: Versao ou ordem de bytes do arquivo binario nao suportada\n";
+    return false;
+  }
+  // As ids sao int32_t e as posicoes em inicio sao uint32_t; com esses limites, as
+  // contas abaixo nao estouram
+  if (cab.Nin > INT32_MAX || cab.Nportas > INT32_MAX || cab.Nout > INT32_MAX ||
+      cab.Nfanin > UINT32_MAX)
+  {
+    cerr << "Erro: Dimensoes invalidas no cabecalho do arquivo binario\n";
+    return false;
+  }
+
+  // Localizacao de cada array dentro do arquivo
+  uint64_t pos_tipo = sizeof(cab);
+  uint64_t pos_inicio = pos_tipo + cab.Nportas + completar(cab.Nportas, 4);
+  uint64_t pos_id_in = pos_inicio + 4 * (uint64_t(cab.Nportas) + 1);
+  uint64_t pos_id_out = pos_id_in + 4 * cab.Nfanin;
+  uint64_t fim = pos_id_out + 4 * uint64_t(cab.Nout);
+  fim += completar(fim, 8);
+  if (fim != A.getTamanho())
+  {
+    cerr << "Erro: Tamanho do arquivo binario incompativel com o cabecalho\n";
+    return false;
+  }
+  if (hashFNV(A.getDados() + pos_tipo, fim - pos_tipo) != cab.checksum)
+  {
+    cerr << "Erro: Checksum do arquivo binario nao confere\n";
+    return false;
+  }
+
+  // Os arrays estao alinhados no arquivo (e mmap devolve enderecos alinhados a pagina)
+  const TipoPorta *tipos = reinterpret_cast<const TipoPorta *>(A.getDados() + pos_tipo);
+  const uint32_t *inicio = reinterpret_cast<const uint32_t *>(A.getDados() + pos_inicio);
+  const int32_t *id_in = reinterpret_cast<const int32_t *>(A.getDados() + pos_id_in);
+  const int32_t *id_out = reinterpret_cast<const int32_t *>(A.getDados() + pos_id_out);
+  if (!validNetlist(cab.Nin, cab.Nportas, tipos, inicio, id_in, cab.Nfanin, cab.Nout, id_out))
+  {
+    cerr << "Erro: Circuito invalido no arquivo binario\n";
+    return false;
+  }
+
+  N.montar(cab.Nin, cab.Nportas, tipos, inicio, id_in, cab.Nout, id_out);
+  return true;
+}
@@ -0,0 +1,70 @@
+#ifndef _BINARIO_H_
+#define _BINARIO_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "netlist.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// FORMATO BINARIO DE CIRCUITO (extensao sugerida: .cbin)
+/// Guarda as mesmas informacoes do formato texto, ja na forma dos arrays da
+/// netlist, para que a leitura nao precise interpretar porta a porta:
+/// - cabecalho (CabecalhoBinario, 48 bytes)
+/// - tipo: NumPorts bytes (TipoPorta da porta de id i+1), completado com zeros
+///   ateh um multiplo de 4 bytes
+/// - inicio: NumPorts+1 inteiros de 32 bits (formato CSR, ver DescricaoCircuito)
+/// - id_in: inicio[NumPorts] inteiros de 32 bits com sinal (ids de origem)
+/// - id_out: NumOutputs inteiros de 32 bits com sinal (ids de origem)
+/// - zeros ateh completar um multiplo de 8 bytes
+/// Os inteiros sao gravados na ordem de bytes do processador (little-endian nos
+/// x86); o campo "ordem" do cabecalho permite detectar um arquivo gravado com a
+/// ordem contraria. O campo "checksum" eh o hash (hashFNV) de tudo que vem
+/// depois do cabecalho.
+/// ###########################################################################
+
+struct CabecalhoBinario
+{
+  char magica[8];    // MAGICA_BINARIO
+  uint32_t ordem;    // ORDEM_BINARIO
+  uint32_t versao;   // VERSAO_BINARIO
+  uint32_t Nin;      // numero de entradas
+  uint32_t Nout;     // numero de saidas
+  uint32_t Nportas;  // numero de portas
+  uint32_t reservado;
+  uint64_t Nfanin;   // numero total de entradas de portas (dimensao de id_in)
+  uint64_t checksum; // hash do restante do arquivo
+};
+
+const char MAGICA_BINARIO[8] = {'C', 'I', 'R', 'C', '3', 'S', 'B', 'N'};
+const uint32_t ORDEM_BINARIO = 0x01020304;
+const uint32_t VERSAO_BINARIO = 1;
+
+// Valor inicial do hash
+const uint64_t HASH_FNV_INICIAL = 0xcbf29ce484222325ULL;
+
+// Hash FNV-1a de 64 bits, aplicado a palavras de 64 bits (os bytes finais que nao
+// completam uma palavra sao tratados um a um). H permite continuar um hash anterior
+uint64_t hashFNV(const void *Dados, size_t N, uint64_t H = HASH_FNV_INICIAL);
+
+// Retorna true se os arrays descrevem um circuito valido (ver Circuito::valid e
+// DescricaoCircuito para o significado dos arrays); Id_in tem dimensao Nfanin
+// Os arrays podem vir de um arquivo corrompido: nenhuma posicao fora deles eh lida
+bool validNetlist(unsigned NI, unsigned NP, const TipoPorta *Tipos, const uint32_t *Inicio,
+                  const int32_t *Id_in, uint64_t Nfanin, unsigned NO, const int32_t *Id_out);
+
+// Grava no formato binario o circuito descrito por D
+// Retorna true se deu tudo OK; false se deu erro
+bool salvarNetlistBinaria(const std::string &arq, const DescricaoCircuito &D);
+
+// Leh um arquivo no formato binario e monta a netlist N diretamente a partir do
+// arquivo mapeado em memoria (ver ArquivoMapeado), sem interpretar porta a porta
+// Confere o cabecalho, o checksum e a validade do circuito
+// Retorna true se deu tudo OK; false se deu erro (N fica vazia)
+bool lerNetlistBinaria(const std::string &arq, Netlist &N);
+
+#endif // _BINARIO_H_
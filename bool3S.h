@@ -1,31 +1,238 @@
 #ifndef _BOOL3S_H_
 #define _BOOL3S_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 
 // Criando um tipo de dados enumerado (bool3S) para representar um booleano com 3 estados:
 // bool3S::TRUE, bool3S::FALSE e bool3S::UNDEF
-enum class bool3S
+// Ocupa um byte, do qual soh os 2 bits menos significativos sao usados (0, 1 ou 2)
+enum class bool3S : uint8_t
 {
   UNDEF,
   FALSE,
   TRUE
 };
 
+/// ###########################################################################
+/// OPERADORES SEM DESVIOS
+/// Na codificacao de bool3S, o bit 0 indica FALSE e o bit 1 indica TRUE (UNDEF
+/// nao tem nenhum dos dois), como os campos f e t de Palavra3S. Os operadores
+/// logicos sao entao operacoes sobre esses bits, sem comparacoes nem desvios, que
+/// o compilador vetoriza nos lacos sobre arrays e combina entre si (NAND, NOR e
+/// NXOR nao custam mais que AND, OR e XOR).
+/// As tabelas-verdade sao geradas em tempo de compilacao (constexpr) a partir das
+/// definicoes abaixo; servem para conferir os operadores (static_assert) e para o
+/// codigo C gerado pela simulacao nativa. Os operadores binarios usam o indice
+/// 4*x1+x2; as posicoes que nao correspondem a valores validos (3) contem UNDEF.
+/// ###########################################################################
+
+namespace tabelas_bool3S
+{
+// As definicoes dos operadores, usadas soh para gerar as tabelas
+constexpr bool3S calcNOT(bool3S x)
+{
+  return (x == bool3S::UNDEF ? bool3S::UNDEF : x == bool3S::TRUE ? bool3S::FALSE : bool3S::TRUE);
+}
+constexpr bool3S calcAND(bool3S x1, bool3S x2)
+{
+  return (x1 == bool3S::FALSE || x2 == bool3S::FALSE ? bool3S::FALSE
+          : x1 == bool3S::UNDEF || x2 == bool3S::UNDEF ? bool3S::UNDEF
+                                                       : bool3S::TRUE);
+}
+constexpr bool3S calcOR(bool3S x1, bool3S x2)
+{
+  return (x1 == bool3S::TRUE || x2 == bool3S::TRUE ? bool3S::TRUE
+          : x1 == bool3S::UNDEF || x2 == bool3S::UNDEF ? bool3S::UNDEF
+                                                       : bool3S::FALSE);
+}
+constexpr bool3S calcXOR(bool3S x1, bool3S x2)
+{
+  return (x1 == bool3S::UNDEF || x2 == bool3S::UNDEF ? bool3S::UNDEF
+          : x1 == x2 ? bool3S::FALSE
+                     : bool3S::TRUE);
+}
+
+// Tabela de um operador unario (indice x) ou binario (indice 4*x1+x2)
+struct Tabela
+{
+  bool3S valor[16];
+};
+constexpr Tabela gerarUnaria(bool3S (*Op)(bool3S))
+{
+  Tabela T{};
+  for (unsigned x = 0; x < 4; x++)
+    T.valor[x] = (x < 3 ? Op(bool3S(x)) : bool3S::UNDEF);
+  return T;
+}
+constexpr Tabela gerarBinaria(bool3S (*Op)(bool3S, bool3S))
+{
+  Tabela T{};
+  for (unsigned x1 = 0; x1 < 4; x1++)
+    for (unsigned x2 = 0; x2 < 4; x2++)
+      T.valor[4 * x1 + x2] = (x1 < 3 && x2 < 3 ? Op(bool3S(x1), bool3S(x2)) : bool3S::UNDEF);
+  return T;
+}
+
+inline constexpr Tabela NOT = gerarUnaria(calcNOT);
+inline constexpr Tabela AND = gerarBinaria(calcAND);
+inline constexpr Tabela OR = gerarBinaria(calcOR);
+inline constexpr Tabela XOR = gerarBinaria(calcXOR);
+
+// Os bits de FALSE e de TRUE
+const unsigned BIT_F = unsigned(bool3S::FALSE);
+const unsigned BIT_T = unsigned(bool3S::TRUE);
+} // namespace tabelas_bool3S
+
 // Os operadores logicos para a classe bool3S
 // Podem ser usados para facilitar a implementacao dos metodos de simulacao de portas logicas
 
-// NOT 3S
-bool3S operator~(bool3S x);
-// AND 3S
-bool3S operator&(bool3S x1, bool3S x2);
-void operator&=(bool3S &x1, bool3S x2);
-// OR 3S
-bool3S operator|(bool3S x1, bool3S x2);
-void operator|=(bool3S &x1, bool3S x2);
-// XOR 3S
-bool3S operator^(bool3S x1, bool3S x2);
-void operator^=(bool3S &x1, bool3S x2);
+// NOT 3S: troca FALSE (01) e TRUE (10), que sao o XOR um do outro com 11; UNDEF
+// (00) continua UNDEF
+constexpr bool3S operator~(bool3S x)
+{
+  return bool3S((unsigned(x) ^ 3) & (0u - unsigned(x != bool3S::UNDEF)));
+}
+// AND 3S: FALSE se algum for FALSE, TRUE se os dois forem TRUE
+constexpr bool3S operator&(bool3S x1, bool3S x2)
+{
+  using namespace tabelas_bool3S;
+  return bool3S(((unsigned(x1) | unsigned(x2)) & BIT_F) | (unsigned(x1) & unsigned(x2) & BIT_T));
+}
+inline void operator&=(bool3S &x1, bool3S x2) { x1 = x1 & x2; }
+// OR 3S: TRUE se algum for TRUE, FALSE se os dois forem FALSE
+constexpr bool3S operator|(bool3S x1, bool3S x2)
+{
+  using namespace tabelas_bool3S;
+  return bool3S(((unsigned(x1) | unsigned(x2)) & BIT_T) | (unsigned(x1) & unsigned(x2) & BIT_F));
+}
+inline void operator|=(bool3S &x1, bool3S x2) { x1 = x1 | x2; }
+// XOR 3S: UNDEF se algum for UNDEF; senao, dois valores definidos diferentes
+// (FALSE e TRUE) tem o bit 0 do seu XOR ligado
+// (o teste de UNDEF eh uma comparacao, mais barata que deslocamentos de bits nos
+// lacos vetorizados, e vira uma mascara, sem desvio)
+constexpr bool3S operator^(bool3S x1, bool3S x2)
+{
+  unsigned def = unsigned(x1 != bool3S::UNDEF) & unsigned(x2 != bool3S::UNDEF);
+  return bool3S((1 + ((unsigned(x1) ^ unsigned(x2)) & 1)) & (0u - def));
+}
+inline void operator^=(bool3S &x1, bool3S x2) { x1 = x1 ^ x2; }
+
+namespace tabelas_bool3S
+{
+// Confere os operadores com as tabelas, para todos os valores validos
+constexpr bool conferirOperadores()
+{
+  for (unsigned x1 = 0; x1 < 3; x1++)
+  {
+    if (~bool3S(x1) != NOT.valor[x1])
+      return false;
+    for (unsigned x2 = 0; x2 < 3; x2++)
+      if ((bool3S(x1) & bool3S(x2)) != AND.valor[4 * x1 + x2] ||
+          (bool3S(x1) | bool3S(x2)) != OR.valor[4 * x1 + x2] ||
+          (bool3S(x1) ^ bool3S(x2)) != XOR.valor[4 * x1 + x2])
+        return false;
+  }
+  return true;
+}
+static_assert(conferirOperadores(), "operadores de bool3S diferentes das tabelas-verdade");
+
+// Os valores sao lidos 8 de cada vez, como os bytes de um uint64_t
+const uint64_t BYTES_BIT0 = 0x0101010101010101ull;
+inline uint64_t ler8(const bool3S *V)
+{
+  uint64_t w;
+  std::memcpy(&w, V, sizeof(w));
+  return w;
+}
+// Combinam os 8 bytes de W com OR, AND ou XOR; o resultado fica no byte menos significativo
+inline unsigned juntarOR(uint64_t W)
+{
+  W |= W >> 32;
+  W |= W >> 16;
+  return unsigned(W | (W >> 8));
+}
+inline unsigned juntarAND(uint64_t W)
+{
+  W &= W >> 32;
+  W &= W >> 16;
+  return unsigned(W & (W >> 8));
+}
+inline unsigned juntarXOR(uint64_t W)
+{
+  W ^= W >> 32;
+  W ^= W >> 16;
+  return unsigned(W ^ (W >> 8));
+}
+
+// A reducao AND (Bit = BIT_F) ou OR (Bit = BIT_T): o resultado tem o bit Bit ligado
+// se ele estiver ligado em algum valor, e o outro bit ligado se estiver em todos
+template <unsigned Bit>
+inline bool3S reduzir(const bool3S *V, size_t N)
+{
+  const unsigned Outro = BIT_F + BIT_T - Bit;
+  uint64_t algum = 0, todos = ~uint64_t(0);
+  size_t i = 0;
+  for (; i + 8 <= N; i += 8)
+  {
+    uint64_t w = ler8(V + i);
+    algum |= w;
+    todos &= w;
+    // Valor absorvente (FALSE no AND, TRUE no OR): o resultado jah estah decidido
+    if (algum & (BYTES_BIT0 * Bit))
+      return bool3S(Bit);
+  }
+  unsigned a = juntarOR(algum), t = juntarAND(todos);
+  for (; i < N; i++)
+  {
+    a |= unsigned(V[i]);
+    t &= unsigned(V[i]);
+  }
+  return bool3S((a & Bit) | (t & Outro));
+}
+} // namespace tabelas_bool3S
+
+// As reducoes n-arias: o AND, OR ou XOR 3S dos N valores do array V (N >= 1)
+// Aplicam os operadores acima a 8 valores de cada vez (os bytes de um uint64_t),
+// sem desvios que dependam de cada valor, e testam a cada 8 valores se o resultado
+// jah estah decidido
+
+inline bool3S reduzirAND(const bool3S *V, size_t N)
+{
+  return tabelas_bool3S::reduzir<tabelas_bool3S::BIT_F>(V, N);
+}
+
+inline bool3S reduzirOR(const bool3S *V, size_t N)
+{
+  return tabelas_bool3S::reduzir<tabelas_bool3S::BIT_T>(V, N);
+}
+
+inline bool3S reduzirXOR(const bool3S *V, size_t N)
+{
+  using namespace tabelas_bool3S;
+  // def: bit 0 ligado nos valores definidos; par: bit 1 (TRUE) com a paridade dos TRUE
+  uint64_t def = ~uint64_t(0), par = 0;
+  size_t i = 0;
+  for (; i + 8 <= N; i += 8)
+  {
+    uint64_t w = ler8(V + i);
+    def &= w | (w >> 1);
+    par ^= w;
+    // Algum UNDEF: o resultado eh UNDEF
+    if ((def & BYTES_BIT0) != BYTES_BIT0)
+      return bool3S::UNDEF;
+  }
+  unsigned d = juntarAND(def), p = juntarXOR(par);
+  for (; i < N; i++)
+  {
+    d &= unsigned(V[i]) | (unsigned(V[i]) >> 1);
+    p ^= unsigned(V[i]);
+  }
+  // UNDEF (0) se algum UNDEF; senao, FALSE (1) ou TRUE (2) conforme a paridade
+  return bool3S((1 + ((p >> 1) & 1)) & (0u - (d & 1)));
+}
 
 // Os operadores de incremento/decremento para a classe bool3S
 
@@ -1,13 +1,20 @@
+#include <fstream>
 #include <iostream>
 #include <string>
 #include "circuito.h"
+#include "tabela.h"
+#include "codigo.h"
+#include "lote.h"
+#include "comandos.h"
 
 using namespace std;
 
-void gerarTabela(Circuito& C);
-
-int main(void)
+int main(int argc, char *argv[])
 {
+  // Com argumentos, executa um comando sem o menu (ver comandos.h)
+  if (argc > 1)
+    return executarComando(argc, argv);
+
   Circuito C;
   string nome;
   int opcao;
@@ -21,96 +28,98 @@ int main(void)
       cout << "3 - Ler um circuito de arquivo\n";
       cout << "4 - Imprimir o circuito na tela\n";
       cout << "5 - Simular o circuito para todas as entrada (gerar tabela verdade)\n";
+      cout << "6 - Salvar um circuito em arquivo binario\n";
+      cout << "7 - Ler um circuito de arquivo binario\n";
+      cout << "8 - Gerar um cabecalho C++ com a simulacao do circuito\n";
+      cout << "9 - Salvar a tabela verdade em arquivo binario\n";
+      cout << "10 - Comparar duas tabelas verdade em arquivos binarios\n";
+      cout << "11 - Simular o circuito para os vetores de entrada de um arquivo\n";
       cout << "Qual sua opcao? ";
       cin >> opcao;
-    } while(opcao<0 || opcao>5);
+    } while(opcao<0 || opcao>11);
     switch(opcao){
     case 1:
       C.digitar();
       break;
     case 2:
    case 3:
+   case 6:
+   case 7:
+   case 8:
+   case 9:
       // Antes de ler a string com o nome do arquivo, esvaziar o buffer do teclado
      cin.ignore(256,'\n');
      do {
        cout << "Arquivo: ";
        getline(cin,nome);
      } while (nome.size() < 3); // Name do arquivo >= 3 caracteres
-     if (opcao==3) {
-       if (!C.ler(nome))
+     if (opcao==3 || opcao==7) {
+       if (!(opcao==3 ? C.ler(nome) : C.lerBinario(nome)))
        {
           // Erro na leitura
          cerr << "Arquivo " << nome << " invalido para leitura\n";
        }
      }
      else {
-      //  if (!C.salvar(nome))
-      //  {
-      //     // Erro no salvamento
-      //     cerr << "Arquivo " << nome << " invalido para escrita\n";
-      //  }
+       if (!(opcao==2 ? C.salvar(nome) : opcao==6 ? C.salvarBinario(nome) :
+             opcao==8 ? salvarCodigo(C, nome) : salvarTabelaBinaria(C, nome)))
+       {
+          // Erro no salvamento
+          cerr << "Arquivo " << nome << " invalido para escrita\n";
+       }
      }
       break;
-  //  case 4:
-    //  C.imprimir();
-   //   break;
-    // case 5:
-    //   gerarTabela(C);
-    //   break;
+    case 4:
+      C.imprimir();
+      break;
+    case 5:
+      if (!gerarTabela(C))
+      {
+        cerr << "Circuito invalido para simulacao\n";
+      }
+      break;
+    case 10:
+      {
+        TabelaBinaria T[2];
+        uint64_t Ndif;
+        cin.ignore(256,'\n');
+        for (int t=0; t<2; t++) {
+          do {
+            cout << "Arquivo " << t+1 << ": ";
+            getline(cin,nome);
+          } while (nome.size() < 3);
+          if (!T[t].abrir(nome)) {
+            cerr << "Arquivo " << nome << " invalido para leitura\n";
+            break;
+          }
+        }
+        if (T[0].aberta() && T[1].aberta()) compararTabelas(T[0], T[1], Ndif);
+      }
+      break;
+    case 11:
+      {
+        string saida;
+        uint64_t Nvetores;
+        cin.ignore(256,'\n');
+        do {
+          cout << "Arquivo de entradas: ";
+          getline(cin,nome);
+        } while (nome.size() < 3);
+        do {
+          cout << "Arquivo de saidas: ";
+          getline(cin,saida);
+        } while (saida.size() < 3);
+        ifstream in(nome);
+        ofstream out(saida);
+        if (!in.is_open()) cerr << "Arquivo " << nome << " invalido para leitura\n";
+        else if (!out.is_open()) cerr << "Arquivo " << saida << " invalido para escrita\n";
+        else if (!simularLote(C, in, out, FormatoLote::TEXTO, FormatoLote::TEXTO, Nvetores))
+          cerr << "Simulacao interrompida apos " << Nvetores << " vetores\n";
+        else cout << Nvetores << " vetores simulados\n";
+      }
+      break;
     // default:
     //   break;
     }
   } while(opcao != 0);
 }
-
-// void gerarTabela(Circuito& C)
-// {
-//   vector<bool3S> in_circ(C.getNumInputs());
-//   int i;
-
-//   // Comeca com todas as entradas indefinidas
-//   for (i=0; i<(int)C.getNumInputs(); i++)
-//   {
-//     in_circ.at(i) = bool3S::UNDEF;
-//   }
-
-//   cout << "ENTRADAS" << '\t' << "SAIDAS" << endl;
-//   do
-//   {
-//     // Simulacao
-//     C.simular(in_circ);
-
-//     // Impressao das entradas
-//     for (i=0; i<(int)C.getNumInputs(); i++)
-//     {
-//       cout << in_circ.at(i);
-//       if (i<(int)C.getNumInputs()-1) cout << ' ';
-//       else
-//       {
-//         cout <<'\t';
-//         if (C.getNumInputs()<=2) cout <<'\t';
-//       }
-//     }
-
-//     // Impressao das saidas
-//     for (i=0; i<(int)C.getNumOutputs(); i++)
-//     {
-//       cout << C.getOutput(i+1);
-//       if (i<(int)C.getNumOutputs()-1) cout << ' ';
-//       else cout << '\n';
-//     }
-
-//     // Determina qual entrada deve ser incrementada na proxima linha
-//     // Incrementa a ultima possivel que nao for TRUE
-//     // Se a ultima for TRUE, faz essa ser UNDEF e tenta incrementar a anterior
-//     i = int(C.getNumInputs())-1;
-//     while (i>=0 && in_circ.at(i)==bool3S::TRUE)
-//     {
-//       in_circ.at(i)++;
-//       i--;
-//     };
-//     // Incrementa a input selecionada
-//     if (i>=0) in_circ.at(i)++;
-//   } while (i>=0);
-// }
-
@@ -1,9 +1,14 @@
+#include <cstddef>
 #include <iostream>
 #include <fstream>
 #include "circuito.h"
 #include "string"
 #include "bool3S.h"
 #include "port.h"
+#include "binario.h"
+#include "arquivo.h"
+#include "leitor.h"
+#include "instrumentacao.h"
 
 // Bernardo Fonseca Andrade de Lima
 // Francisco de Assis Vilela Neto
@@ -29,32 +34,65 @@ bool validType(std::string &Tipo)
   return false;
 }
 
-// Funcao auxiliar que retorna um ponteiro que aponta para uma porta alocada dinamicamente
-// O tipo da porta alocada depende do parametro string de entrada (AN, OR, etc.)
+// Funcao auxiliar que retorna um ponteiro que aponta para uma porta criada na arena A
+// O tipo da porta criada depende do parametro de entrada (AN, OR, etc.)
+ptr_Port allocPort(TipoPorta Tipo, ArenaPortas &A)
+{
+  switch (Tipo)
+  {
+  case TipoPorta::NT:
+    return A.criar<Port_NOT>();
+  case TipoPorta::AN:
+    return A.criar<Port_AND>();
+  case TipoPorta::NA:
+    return A.criar<Port_NAND>();
+  case TipoPorta::OR:
+    return A.criar<Port_OR>();
+  case TipoPorta::NO:
+    return A.criar<Port_NOR>();
+  case TipoPorta::XO:
+    return A.criar<Port_XOR>();
+  case TipoPorta::NX:
+    return A.criar<Port_NXOR>();
+  }
+  // Nunca deve chegar aqui...
+  return nullptr;
+}
+
+// Idem, com o tipo dado pela sigla (string)
 // Caso o tipo nao seja nenhum dos validos, retorna nullptr
 // Pode ser utilizada nas funcoes: Circuito::setPort, Circuito::digitar e Circuito::ler
-ptr_Port allocPort(std::string &Tipo)
+ptr_Port allocPort(const std::string &Tipo, ArenaPortas &A)
 {
-  if (!validType(Tipo))
+  TipoPorta T;
+  if (!toTipoPorta(Tipo, T))
     return nullptr;
+  return allocPort(T, A);
+}
 
-  if (Tipo == "NT")
-    return new Port_NOT;
-  if (Tipo == "AN")
-    return new Port_AND;
-  if (Tipo == "NA")
-    return new Port_NAND;
-  if (Tipo == "OR")
-    return new Port_OR;
-  if (Tipo == "NO")
-    return new Port_NOR;
-  if (Tipo == "XO")
-    return new Port_XOR;
-  if (Tipo == "NX")
-    return new Port_NXOR;
+///
+/// CLASSE CONTEXTO DE SIMULACAO
+///
 
-  // Nunca deve chegar aqui...
-  return nullptr;
+ContextoSimulacao::ContextoSimulacao() : avaliacoes_lacos(0) {}
+
+unsigned ContextoSimulacao::getNumOutputs() const
+{
+  return out_circ.size();
+}
+
+bool3S ContextoSimulacao::getOutput(int IdOutput) const
+{
+  if (IdOutput >= 1 && IdOutput <= int(getNumOutputs()))
+    return out_circ[IdOutput - 1];
+  return bool3S::UNDEF;
+}
+
+unsigned ContextoSimulacao::getAvaliacoesLacos() const { return avaliacoes_lacos; }
+
+const std::vector<bool3S> &ContextoSimulacao::getValores() const
+{
+  return valores;
 }
 
 ///
@@ -65,7 +103,46 @@ ptr_Port allocPort(std::string &Tipo)
 /// Inicializacao e finalizacao
 /// ***********************
 
-Circuito::Circuito() : Nin(0), Nout(0), Nportas(0) {}
+Circuito::Circuito() : Nin(0), Nout(0), Nportas(0), circ_valido(false), compilado(false) {}
+
+Circuito::Circuito(const Circuito &C) : Circuito()
+{
+  *this = C;
+}
+
+void Circuito::operator=(const Circuito &C)
+{
+  if (this == &C)
+    return;
+  clear();
+  if (C.getNumPorts() == 0)
+    return;
+
+  // Uma soh alocacao de bloco para todas as portas e seus vetores id_in
+  size_t previsto = 0;
+  for (unsigned i = 0; i < C.getNumPorts(); i++)
+    if (C.ports[i] != nullptr)
+      previsto += sizeof(Port_NOT) + alignof(std::max_align_t) + C.ports[i]->getNumInputs() * sizeof(int);
+  arena.liberar(previsto);
+
+  Nin = C.Nin;
+  Nout = C.Nout;
+  Nportas = C.Nportas;
+  id_out = C.id_out;
+  out_circ = C.out_circ;
+  ports.resize(C.getNumPorts());
+  for (unsigned i = 0; i < getNumPorts(); i++)
+    ports[i] = (C.ports[i] != nullptr ? C.ports[i]->clone(arena) : nullptr);
+
+  // Aproveita a netlist de C, se ela estiver pronta
+  if (C.compilado.load(memory_order_acquire))
+  {
+    lock_guard<mutex> trava(C.trava_compilacao);
+    netlist = C.netlist;
+    circ_valido = C.circ_valido;
+    compilado.store(true, memory_order_release);
+  }
+}
 
 void Circuito::clear()
 {
@@ -75,24 +152,27 @@ void Circuito::clear()
   id_out.clear();
   out_circ.clear();
   ports.clear();
+  arena.liberar();
+  netlist.clear();
+  compilado = false;
 }
 
 Circuito::~Circuito() { clear(); }
 
 void Circuito::resize(unsigned int Nentradas, unsigned int Nsaidas, unsigned int Nport)
 {
-  cout << "resize";
-  if (Nentradas<0 || Nsaidas<0 || Nport<0)
+  if (Nentradas == 0 || Nsaidas == 0 || Nport == 0)
   {
     cout << "parametros de Resize invalidos";
     return;
   }
-  
+
   clear();
   Nin = Nentradas;
   Nout = Nsaidas;
   Nportas = Nport;
   id_out.resize(Nsaidas);
+  out_circ.resize(Nsaidas);
   ports.resize(Nport);
 
   for (unsigned i = 0; i < getNumOutputs(); i++)
@@ -259,28 +339,74 @@ void Circuito::setIdOutput(int IdOut, int IdOrig)
   if (validIdOutput(IdOut) && validIdOrig(IdOrig))
   {
     id_out[IdOut - 1] = IdOrig;
+    compilado = false;
   }
 }
 
 void Circuito::setPort(int IdPort, std::string Tipo, unsigned NIn)
 {
-  if (validIdPort(IdPort) && validType(Tipo) && validIdInput(NIn))
+  if (validIdPort(IdPort) && validType(Tipo))
   {
-    delete ports[IdPort - 1];
+    ptr_Port nova = allocPort(Tipo, arena);
+    if (!nova->validNumInputs(NIn))
+      return;
 
-    ports[IdPort - 1] = allocPort(Tipo);
+    ports[IdPort - 1] = nova;
 
     ports[IdPort - 1]->setNumInputs(NIn);
+    compilado = false;
   }
 }
 
-void Circuito::setId_inPort(int IdPort, unsigned I, int IdOrig) const
+void Circuito::setId_inPort(int IdPort, unsigned I, int IdOrig)
 {
   if (definedPort(IdPort) && ports[IdPort - 1]->validIndex(I) && validIdOrig(IdOrig))
+  {
     ports[IdPort - 1]->setId_in(I, IdOrig);
+    compilado = false;
+  }
 }
 
-// falta_fazer();
+void Circuito::descrever(DescricaoCircuito &D) const
+{
+  D.Nin = getNumInputs();
+  D.tipos.resize(getNumPorts());
+  D.inicio.assign(getNumPorts() + 1, 0);
+  D.id_in.clear();
+  for (unsigned i = 0; i < getNumPorts(); i++)
+  {
+    D.tipos[i] = ports[i]->getTipo();
+    for (unsigned j = 0; j < ports[i]->getNumInputs(); j++)
+      D.id_in.push_back(ports[i]->getId_in(j));
+    D.inicio[i + 1] = D.id_in.size();
+  }
+  D.id_out = id_out;
+}
+
+bool Circuito::definir(const DescricaoCircuito &D)
+{
+  unsigned NP = D.tipos.size();
+  unsigned NO = D.id_out.size();
+
+  clear();
+  if (D.inicio.size() != NP + 1 || D.id_in.size() > UINT32_MAX ||
+      !validNetlist(D.Nin, NP, D.tipos.data(), D.inicio.data(), D.id_in.data(), D.id_in.size(), NO,
+                    D.id_out.data()))
+    return false;
+
+  resize(D.Nin, NO, NP);
+  // Uma soh alocacao de bloco para todas as portas e seus vetores id_in
+  arena.liberar(NP * (sizeof(Port_NOT) + alignof(std::max_align_t)) + D.id_in.size() * sizeof(int));
+  for (unsigned i = 0; i < NP; i++)
+  {
+    ports[i] = allocPort(D.tipos[i], arena);
+    ports[i]->setNumInputs(D.inicio[i + 1] - D.inicio[i]);
+    for (uint32_t j = D.inicio[i]; j < D.inicio[i + 1]; j++)
+      ports[i]->setId_in(j - D.inicio[i], D.id_in[j]);
+  }
+  id_out = D.id_out;
+  return true;
+}
 
 /// ***********************
 /// E/S de dados
@@ -292,7 +418,6 @@ void Circuito::digitar()
   unsigned int Nsaidas;
   unsigned int Nport;
   string sigla_porta;
-  bool porta_valida;
   
   cout << "Informe o numero de entradas (Nin): \n";
   cin >> Nentradas;
@@ -316,7 +441,7 @@ void Circuito::digitar()
   }
   
   // Redimensiona o circuito
-  // this->resize(Nentradas, Nsaidas, Nport);   // Nao ta funcionando, por isso comentei
+  this->resize(Nentradas, Nsaidas, Nport);
 
   Port_NOT NT;
   Port_AND AN;
@@ -332,8 +457,7 @@ void Circuito::digitar()
     cout << "Portas disponiveis: (NT,AN,NA,OR,NO,XO,NX) \n";
     cout << "Informe a porta que deseja criar: ";
     getline(cin,sigla_porta);
-    
-cout << "SP2: "<< sigla_porta <<endl;
+
     while (!validType(sigla_porta))
     {
       cin.ignore(256,'\n');
@@ -343,20 +467,20 @@ cout << "SP2: "<< sigla_porta <<endl;
     }
 
     if (sigla_porta == "NT"){
-      ports.push_back((&NT)->clone());
+      ports[i] = (&NT)->clone(arena);
     }
     else if (sigla_porta == "AN")
-      ports.push_back((&AN)->clone());
+      ports[i] = (&AN)->clone(arena);
     else if (sigla_porta == "NA")
-      ports.push_back((&NA)->clone());
+      ports[i] = (&NA)->clone(arena);
     else if (sigla_porta == "OR")
-      ports.push_back((&OR)->clone());
+      ports[i] = (&OR)->clone(arena);
     else if (sigla_porta == "NO")
-      ports.push_back((&NOR)->clone());
+      ports[i] = (&NOR)->clone(arena);
     else if (sigla_porta == "XO")
-      ports.push_back((&XO)->clone());
+      ports[i] = (&XO)->clone(arena);
     else if (sigla_porta == "NX")
-      ports.push_back((&NX)->clone());
+      ports[i] = (&NX)->clone(arena);
     else
     {
       cout << "Erro: Essa porta não existe. ";
@@ -364,183 +488,235 @@ cout << "SP2: "<< sigla_porta <<endl;
       return;
     }
     ports[i]->digitar();
+  }
 
-    int ID;
-    for (unsigned i = 0; i < Nout; i++)
+  int ID;
+  for (unsigned i = 0; i < Nsaidas; i++)
+  {
+    cout << "ID do sinal que vai para a saida " << i + 1 << endl;
+    cin >> ID;
+    if (validIdOrig(ID))
     {
-      cout << "ID do sinal que vai para a saida " << i + 1 << endl;
-      cin >> ID;
-      if (validIdOrig(ID))
-      {
-        id_out[i] = ID;
-      }
-      else
+      id_out[i] = ID;
+    }
+    else
+    {
+      do
       {
-        do
-        {
-          cout << "ID invalido. Por favor, digite outro ID do sinal. \n";
-          cin >> ID;
-        } while (!validIdOrig(ID));
-        id_out[i] = ID; // Se chegou aqui, eh, pq o ID ja estah validado
-      }
+        cout << "ID invalido. Por favor, digite outro ID do sinal. \n";
+        cin >> ID;
+      } while (!validIdOrig(ID));
+      id_out[i] = ID; // Se chegou aqui, eh, pq o ID ja estah validado
     }
   }
 }
 
 bool Circuito::ler(const std::string &arq)
 {
-  cout << arq;
-  ifstream arquivo(arq);
-  string prov, tipo;
-  int NI, NO, NP, Nin;
-  if (arquivo.is_open())
+  INSTR_FASE(LEITURA);
+  ArquivoMapeado A;
+  DescricaoCircuito D;
+
+  clear();
+  if (!A.abrir(arq))
+    return false;
+  if (!lerTextoCircuito(A.getDados(), A.getTamanho(), D))
+    return false;
+  if (!definir(D))
   {
-    arquivo >> prov >> NI >> NO >> NP;
-  
-    if (prov != "CIRCUITO" || NI <= 0 || NO <= 0 || NP <= 0)
-    {
-      cout << "Erro: Cabecalho fora do padrao esperado.\n";
-      return false;
-    }
-    // resize(NI, NO, NP);  // Não tá funcionando
-    arquivo.ignore(255, '\n');
-    arquivo >> prov;
-    if (prov != "PORTAS")
-    {
-      cout << "Erro: Palavra chave 'PORTAS'";
-      return false;
-    }
-    arquivo.ignore(255, '\n');
-
-    Port_NOT NT;
-    Port_AND AN;
-    Port_NAND NA;
-    Port_OR OR;
-    Port_NOR NOR;
-    Port_XOR XO;
-    Port_NXOR NX;
-    int i = 0, int_prov;
-    do
-    {
-      arquivo >> int_prov;
-      if (int_prov != i + 1)
-      {
-        cout << "Portas faltando ou nao estao ordenadas\n";
-        return false;
-      }
-      arquivo.ignore(255, ' ');
-      arquivo >> tipo;
+    cerr << "Erro: Circuito invalido\n";
+    return false;
+  }
+  return true;
+}
 
-      if (!validType(tipo))
-      {
-        cout << "Tipo de porta invalido. Por favor, verifique o arquivo e tente novamente. \n";
-      }
-
-      if (tipo == "NT")
-        ports[i] = (&NT)->clone();
-      else if (tipo == "AN")
-        ports[i] = (&AN)->clone();
-      else if (tipo == "NA")
-        ports[i] = (&NA)->clone();
-      else if (tipo == "OR")
-        ports[i] = (&OR)->clone();
-      else if (tipo == "NO")
-        ports[i] = (&NOR)->clone();
-      else if (tipo == "XO")
-        ports[i] = (&XO)->clone();
-      else if (tipo == "NX")
-        ports[i] = (&NX)->clone();
-      else
-        cout << "Tipo de porta inexistente";
-
-      if (!ports[i]->ler(arquivo))
-      {
-        cout << "Erro: Não foi possivel ler o arquivo para a porta i = " << i + 1 << endl;
-        return false;
-      }
-      i++;
-    } while (i < NP);
-
-    arquivo >> prov;
-    if (prov != "SAIDAS:")
-    {
-      cout << "Erro: Palavra chave 'SAIDAS:'";
-      return false;
-    }
-    arquivo.ignore(255, '\n');
+std::ostream &Circuito::imprimir(std::ostream &O) const
+{
+  if (!valid())
+    return O;
 
-    i = 0;
-    for (unsigned i = 0; i < NO; i++)
-    {
-      arquivo >> int_prov;
-      if (int_prov != i + 1)
-      {
-        cout << "Saidas fora de ordem, ou fantando\n";
-        return false;
-      }
-      arquivo.ignore(255, ' ');
+  O << "CIRCUITO " << getNumInputs() << ' ' << getNumOutputs() << ' ' << getNumPorts() << endl;
+  O << "PORTAS" << endl;
+  for (unsigned i = 0; i < getNumPorts(); i++)
+  {
+    O << i + 1 << ") " << *ports[i] << endl;
+  }
+  O << "SAIDAS" << endl;
+  for (unsigned i = 0; i < getNumOutputs(); i++)
+  {
+    O << i + 1 << ") " << id_out[i] << endl;
+  }
+  return O;
+}
 
-      arquivo >> int_prov; // Não sei se deve ser lido de novo
-      if (!validIdPort(NP))
-      {
-        cout << "Erro: Id out > Nportas";
-        return false;
-      }
+bool Circuito::salvar(const std::string &arq) const
+{
+  INSTR_FASE(SAIDA);
+  if (!valid())
+    return false;
 
-      id_out[i] = int_prov;
-    }
+  ofstream arquivo(arq);
+  if (!arquivo.is_open())
+    return false;
+  imprimir(arquivo);
+  arquivo.close();
+  return !arquivo.fail();
+}
+
+bool Circuito::salvarBinario(const std::string &arq) const
+{
+  INSTR_FASE(SAIDA);
+  if (!valid())
+    return false;
+
+  DescricaoCircuito D;
+  descrever(D);
+  return salvarNetlistBinaria(arq, D);
+}
+
+bool Circuito::lerBinario(const std::string &arq)
+{
+  INSTR_FASE(LEITURA);
+  Netlist N;
+  if (!lerNetlistBinaria(arq, N))
+  {
+    clear();
+    return false;
   }
-  
+
+  // Cria as portas a partir da netlist (que estah na ordem de simulacao)
+  resize(N.getNumInputs(), N.getNumOutputs(), N.getNumPorts());
+  for (unsigned k = 0; k < N.getNumPorts(); k++)
+  {
+    ptr_Port P = allocPort(N.getTipo(k), arena);
+    P->setNumInputs(N.getNumInputsPort(k));
+    for (unsigned j = 0; j < N.getNumInputsPort(k); j++)
+      P->setId_in(j, N.idOrig(N.getFanin(k)[j]));
+    ports[N.getIdPort(k) - 1] = P;
+  }
+  for (unsigned j = 0; j < N.getNumOutputs(); j++)
+    id_out[j] = N.idOrig(N.getSaida(j));
+
+  // A netlist lida jah corresponde aas portas: nao precisa ser montada de novo
+  netlist = std::move(N);
+  circ_valido = true;
+  compilado.store(true, memory_order_release);
   return true;
-};
+}
 
-// falta_fazer();
+// Operador de impressao da classe Circuito
+std::ostream &operator<<(std::ostream &O, const Circuito &C)
+{
+  return C.imprimir(O);
+}
 
 /// ***********************
 /// SIMULACAO (funcao principal do circuito)
 /// ***********************
 
-bool Circuito::simular(const std::vector<bool3S> &in_circ)
+void Circuito::montarNetlist() const
 {
-  bool tudo_def, alguma_def;
-  vector<bool3S> in_port;
+  INSTR_FASE(COMPILACAO);
+  netlist.clear();
+  circ_valido = valid();
+  if (!circ_valido)
+    return;
+
+  DescricaoCircuito D;
+  descrever(D);
+  netlist.montar(D);
+}
 
-  for (unsigned i = 0; i < Nportas; i++)
+void Circuito::compilar() const
+{
+  // Soh monta se o circuito foi alterado: a netlist pode estar em uso por outras threads
+  getNetlist();
+}
+
+const Netlist &Circuito::getNetlist() const
+{
+  // Verificacao dupla: depois de compilado, nao ha custo de trava
+  if (!compilado.load(memory_order_acquire))
   {
-    ports[i]->setOutput(bool3S::UNDEF);
+    lock_guard<mutex> trava(trava_compilacao);
+    if (!compilado.load(memory_order_relaxed))
+    {
+      montarNetlist();
+      compilado.store(true, memory_order_release);
+    }
   }
+  return netlist;
+}
+
+bool Circuito::simular(const std::vector<bool3S> &in_circ, ContextoSimulacao &Ctx) const
+{
+  const Netlist &N = getNetlist();
+  if (!circ_valido || in_circ.size() != getNumInputs())
+    return false;
 
-  do
+  Ctx.valores.resize(N.getNumSinais());
+  Ctx.out_circ.resize(N.getNumOutputs());
+  Ctx.avaliacoes_lacos = N.simular(in_circ.data(), Ctx.valores.data());
+
+  // As saidas do circuito
+  for (unsigned j = 0; j < N.getNumOutputs(); j++)
+    Ctx.out_circ[j] = Ctx.valores[N.getSaida(j)];
+  return true;
+}
+
+bool Circuito::resimular(const std::vector<bool3S> &in_circ, const std::vector<int> &IdsAlterados,
+                         ContextoSimulacao &Ctx) const
+{
+  const Netlist &N = getNetlist();
+  if (!circ_valido || in_circ.size() != getNumInputs())
+    return false;
+  if (Ctx.valores.size() != N.getNumSinais())
+    return simular(in_circ, Ctx);
+
+  vector<uint32_t> alteradas;
+  alteradas.reserve(IdsAlterados.size());
+  for (unsigned i = 0; i < IdsAlterados.size(); i++)
   {
-    tudo_def = true;
-    alguma_def = false;
+    if (!validIdInput(IdsAlterados[i]))
+      return false;
+    alteradas.push_back(N.sinal(IdsAlterados[i]));
+  }
+  N.resimular(in_circ.data(), alteradas.data(), alteradas.size(), Ctx.valores.data(), Ctx.fila);
 
-    for (unsigned i = 0; i < Nportas; i++)
-    {
-      if (ports[i]->getOutput() == bool3S::UNDEF)
-      {
+  for (unsigned j = 0; j < N.getNumOutputs(); j++)
+    Ctx.out_circ[j] = Ctx.valores[N.getSaida(j)];
+  return true;
+}
 
-        for (unsigned j = 0; j < ports[i]->getNumInputs(); i++)
-        {
-          if (ports[i]->getId_in(j) > 0){
-            in_port[j] = ports[ports[i]->getId_in(j) - 1]->getOutput();
-          }
-          else {
-            in_port[j] = in_circ[-1 * (ports[i]->getId_in(j)) - 1];
-          }
-        }
-
-        ports[i]->simular(in_port);
-
-        if (ports[i]->getOutput() == bool3S::UNDEF)
-        {
-          tudo_def = false;
-        }
-        else
-        {
-          alguma_def = true;
-        }
-      }
-    }
-  } while (!tudo_def && alguma_def);
+bool Circuito::simular(const std::vector<bool3S> &in_circ)
+{
+  if (!simular(in_circ, contexto))
+    return false;
+  out_circ = contexto.out_circ;
+  return true;
+}
+
+bool Circuito::simular(const std::vector<Palavra3S> &in_circ, std::vector<Palavra3S> &out_lote) const
+{
+  const Netlist &N = getNetlist();
+  if (!circ_valido || in_circ.size() != getNumInputs())
+    return false;
+
+  vector<Palavra3S> valores_lote(N.getNumSinais());
+  N.simular(in_circ.data(), valores_lote.data());
+
+  out_lote.resize(getNumOutputs());
+  for (unsigned j = 0; j < getNumOutputs(); j++)
+    out_lote[j] = valores_lote[N.getSaida(j)];
+  return true;
+}
+
+bool Circuito::diagnosticarLacos(const ContextoSimulacao &Ctx, std::vector<DiagnosticoLaco> &Lacos) const
+{
+  const Netlist &N = getNetlist();
+  Lacos.clear();
+  if (!circ_valido || Ctx.valores.size() != N.getNumSinais())
+    return false;
+  N.diagnosticarLacos(Ctx.valores.data(), Lacos);
+  return true;
 }
@@ -1,11 +1,15 @@
 #ifndef _CIRCUITO_H_
 #define _CIRCUITO_H_
 
+#include <atomic>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <vector>
 #include "bool3S.h"
 #include "port.h"
+#include "netlist.h"
+#include "palavra3S.h"
 
 // Bernardo Fonseca Andrade de Lima
 // Francisco de Assis Vilela Neto
@@ -24,6 +28,49 @@ using namespace std;
 ///       (id da origem de uma entrada de porta ou de uma saida do circuito)
 /// ###########################################################################
 
+///
+/// CLASSE CONTEXTO DE SIMULACAO
+///
+
+// O estado de uma simulacao de circuito: os valores de todos os sinais da netlist
+// e das saidas do circuito. Separado da classe Circuito para que um mesmo circuito
+// possa ser simulado ao mesmo tempo por varias threads, cada uma com o seu contexto
+// (ver Circuito::simular(in_circ, Ctx))
+// Um contexto pode ser reutilizado em varias simulacoes (evita realocacoes)
+class ContextoSimulacao
+{
+private:
+  // Os valores de todos os sinais da netlist (ver netlist.h)
+  std::vector<bool3S> valores;
+  // Os valores logicos das saidas do circuito
+  std::vector<bool3S> out_circ;
+  // A fila de eventos da simulacao incremental
+  FilaEventos fila;
+  // Numero de portas avaliadas na parte com realimentacao na ultima simulacao
+  unsigned avaliacoes_lacos;
+
+  friend class Circuito;
+
+public:
+  // Cria um contexto vazio (dimensionado pela primeira simulacao)
+  ContextoSimulacao();
+
+  // Retorna o numero de saidas do circuito simulado
+  unsigned getNumOutputs() const;
+
+  // Retorna o valor logico da saida cuja id eh IdOutput (de 1 a NumOutputs)
+  // ou bool3S::UNDEF se parametro invalido
+  bool3S getOutput(int IdOutput) const;
+
+  // Retorna os valores de todos os sinais da netlist na ultima simulacao
+  const std::vector<bool3S> &getValores() const;
+
+  // Retorna o numero de portas avaliadas na parte com realimentacao na ultima
+  // simulacao completa (Circuito::simular): cada porta eh avaliada ao menos uma vez,
+  // e as avaliacoes alem dessas medem o custo de chegar ao ponto fixo nos lacos
+  unsigned getAvaliacoesLacos() const;
+};
+
 ///
 /// CLASSE CIRCUIT
 ///
@@ -53,8 +100,29 @@ private:
   std::vector<bool3S> out_circ; // vetor a ser alocado com dimensao "Nout"
 
   // As portas
+  // Todas sao criadas na arena do circuito, junto com os seus vetores id_in: criar,
+  // copiar e limpar um circuito grande exige poucas alocacoes, e a liberacao eh feita
+  // de uma soh vez (ver ArenaPortas)
+  ArenaPortas arena;
   std::vector<ptr_Port> ports; // vetor a ser alocado com dimensao "Nports"
 
+  // A netlist compilada a partir das portas, usada na simulacao (ver netlist.h)
+  // Eh montada sob demanda, inclusive por funcoes const (por isso mutable)
+  mutable Netlist netlist;
+  // Resultado de valid() no momento da compilacao
+  mutable bool circ_valido;
+  // true se a netlist corresponde aas portas atuais do circuito
+  // As funcoes que alteram as portas fazem compilado <- false
+  mutable std::atomic<bool> compilado;
+  // Garante que soh uma thread monta a netlist
+  mutable std::mutex trava_compilacao;
+
+  // O contexto usado pela versao de simular que guarda as saidas em out_circ
+  ContextoSimulacao contexto;
+
+  // Monta a netlist (a thread deve estar com trava_compilacao)
+  void montarNetlist() const;
+
 public:
   /// ***********************
   /// Inicializacao e finalizacao
@@ -69,22 +137,24 @@ public:
   // Nin e os vetores id_out e out_circ serao copias dos equivalentes no Circuit C
   // O vetor ports terah a mesma dimensao do equivalente no Circuit C
   // Serah necessario utilizar a funcao virtual clone para criar copias das portas
+  // (na arena deste circuito)
+  // Se C jah estiver compilado, a netlist tambem eh copiada
   Circuito(const Circuito &C);
   // Destrutor: apenas chama a funcao clear()
   ~Circuito(); // ====== FEITO ======
 
   // Limpa todo o conteudo do circuito. Faz Nin <- 0 e
   // utiliza o metodo STL clear para limpar os vetores id_out, out_circ e ports
-  // ATENCAO: antes de dar um clear no vetor ports, tem que liberar (delete) as areas
-  // de memoria para as quais cada ponteiro desse vetor aponta.
+  // As portas nao sao liberadas uma a uma: toda a arena eh liberada de uma vez
   void clear(); //    ======== FEITO =========
 
   // Operador de atribuicao
   // Atribui (faz copia) de Nin e dos vetores id_out e out_circ
-  // ATENCAO: antes de alterar o vetor ports, tem que liberar (delete) as areas
-  // de memoria para as quais cada ponteiro desse vetor aponta.
+  // Antes de alterar o vetor ports, limpa o circuito (clear), liberando a arena
   // O vetor ports terah a mesma dimensao do equivalente no Circuit C
   // Serah necessario utilizar a funcao virtual clone para criar copias das portas
+  // (na arena deste circuito)
+  // Se C jah estiver compilado, a netlist tambem eh copiada
   void operator=(const Circuito &C);
 
   // Redimensiona o circuito para passar a ter NI entradas, NO saidas e NP ports
@@ -189,15 +259,26 @@ public:
 
   // A porta cuja id eh IdPort passa a ser do tipo Tipo (NT, AN, etc.), com NIn entradas
   // Depois de varios testes (Id, tipo, num de entradas), faz:
-  // 1) Libera a antiga area de memoria: delete ports[IdPort-1]
-  // 2) Cria a nova porta: ports[IdPort-1] <- new ... (de acordo com tipo)
+  // 1) Descarta a antiga porta (a memoria dela soh volta a ser usada no proximo clear)
+  // 2) Cria a nova porta na arena: ports[IdPort-1] <- ... (de acordo com tipo)
   // 3) Fixa o numero de entrada: ports[IdPort-1]->setNumInputs(NIn)
   void setPort(int IdPort, std::string Tipo, unsigned NIn); // ===== FEITO =====
 
   // Altera a origem da I-esima entrada da porta cuja id eh IdPort, que passa a ser "IdOrig"
   // Depois de VARIOS testes (definedPort, validIndex, validIdOrig)
   // faz: ports[IdPort-1]->setId_in(I,Idorig)
-  void setId_inPort(int IdPort, unsigned I, int IdOrig) const; // ===== FEITO =====
+  void setId_inPort(int IdPort, unsigned I, int IdOrig); // ===== FEITO =====
+
+  // O circuito inteiro
+
+  // Preenche D com a descricao do circuito no formato das ids (ver DescricaoCircuito)
+  // Soh deve ser usada se o circuito for valido
+  void descrever(DescricaoCircuito &D) const;
+
+  // O circuito passa a ser o descrito por D (ver DescricaoCircuito), depois de testar
+  // se a descricao eh valida (validNetlist). Todas as portas sao criadas de uma vez.
+  // Retorna true se deu tudo OK; false se a descricao for invalida (o circuito fica vazio)
+  bool definir(const DescricaoCircuito &D);
 
   /// ***********************
   /// E/S de dados
@@ -215,14 +296,13 @@ public:
   void digitar(); // ===== FEITO =====
 
   // Entrada dos dados de um circuito via arquivo
-  // Leh do arquivo o cabecalho com o numero de entradas, saidas e portas
-  // Em seguida, para cada porta leh e confere a id e o tipo (validType)
-  // Apos criada dinamicamente (allocPort) a porta do tipo correto, chama a
-  // funcao ler na porta recem-criada. O retorno da leitura da porta eh conferido
-  // bem como se a porta lida eh valida (validPort) para o circuito.
-  // Em seguida, leh as ids de todas as saidas, que sao conferidas (validIdOrig)
+  // O arquivo inteiro eh mapeado em memoria (ArquivoMapeado) e interpretado por
+  // lerTextoCircuito (ver leitor.h), sem usar streams: leh o cabecalho com o numero
+  // de entradas, saidas e portas; em seguida, para cada porta, confere a id e o tipo
+  // e leh as ids das entradas; por fim, leh as ids de todas as saidas.
+  // O circuito lido eh conferido e criado de uma vez (definir).
+  // Em caso de erro, informa a linha e a coluna do arquivo em que ele ocorreu
   // Retorna true se deu tudo OK; false se deu erro.
-  // Deve utilizar o metodo ler da classe Port
   bool ler(const std::string &arq); // ===== FEITO =====
 
   // Saida dos dados de um circuito (em tela ou arquivo, a mesma funcao serve para os dois)
@@ -235,19 +315,82 @@ public:
   // Retorna true se deu tudo OK; false se deu erro
   bool salvar(const std::string &arq) const;
 
+  // Salvar circuito em arquivo no formato binario (ver binario.h), caso o circuito
+  // seja valido. Retorna true se deu tudo OK; false se deu erro
+  bool salvarBinario(const std::string &arq) const;
+
+  // Entrada dos dados de um circuito via arquivo no formato binario (ver binario.h)
+  // A netlist eh montada diretamente a partir do arquivo mapeado em memoria
+  // (lerNetlistBinaria), e as portas sao criadas a partir dela
+  // Retorna true se deu tudo OK; false se deu erro.
+  bool lerBinario(const std::string &arq);
+
   /// ***********************
   /// SIMULACAO (funcao principal do circuito)
   /// ***********************
 
+  // Monta a netlist compilada a partir das portas (ver Netlist::montar), o que inclui
+  // calcular a ordem de simulacao das portas (ordem topologica por niveis)
+  // a partir das ids de entrada de cada porta, e guarda o resultado no circuito.
+  // Eh chamada automaticamente por simular() quando o circuito foi alterado
+  // desde a ultima compilacao (ler, digitar, setPort, setId_inPort, etc.),
+  // mas pode ser chamada antes para tirar esse custo da primeira simulacao.
+  // Se o circuito jah estiver compilado, nao faz nada: por isso pode ser chamada
+  // enquanto outras threads simulam o circuito (desde que nenhuma o altere).
+  void compilar() const;
+
+  // Retorna a netlist compilada do circuito (chama compilar, se necessario)
+  // Soh deve ser usada se o circuito for valido
+  // Pode ser chamada por varias threads ao mesmo tempo, desde que nenhuma delas
+  // esteja alterando o circuito
+  const Netlist &getNetlist() const;
+
   // Calcula a saida das portas do circuito para os valores de entrada
   // passados como parametro, caso o circuito e a dimensao da entrada sejam
   // validos (caso contrario retorna false)
   // A entrada eh um vetor de bool3S, com dimensao igual ao numero de entradas
   // do circuito.
+  // As portas da parte aciclica sao simuladas uma unica vez, na ordem calculada por
+  // compilar(); a parte com realimentacao eh simulada um laco (componente fortemente
+  // conexa) de cada vez, em ordem topologica: as portas de cada laco sao reavaliadas
+  // ate que nenhuma saida de porta indefinida passe a ser definida (ponto fixo), e as
+  // portas fora de lacos sao simuladas uma unica vez (ver Netlist).
   // Depois de simular todas as portas do circuito, calcula as saidas do
   // circuito (out_circ <- ...)
   // Retorna true se a simulacao foi OK; false caso deh erro
   bool simular(const std::vector<bool3S> &in_circ);
+
+  // Simula o circuito como a funcao anterior, mas guarda os valores de todos os
+  // sinais e as saidas do circuito no contexto Ctx, em vez de no proprio circuito
+  // Como nao altera o circuito, pode ser chamada por varias threads ao mesmo tempo,
+  // cada uma com o seu contexto, sem travas nem copias do circuito (desde que
+  // nenhuma thread esteja alterando o circuito)
+  // Retorna true se a simulacao foi OK; false caso deh erro
+  bool simular(const std::vector<bool3S> &in_circ, ContextoSimulacao &Ctx) const;
+
+  // Simulacao incremental: Ctx deve conter o resultado de uma simulacao anterior
+  // do circuito (simular ou resimular com o mesmo Ctx), e soh as entradas cujas ids
+  // (de -1 a -NumInputs) estao em IdsAlterados podem ter valores diferentes em in_circ.
+  // Soh as portas alcancadas pelas entradas alteradas sao reavaliadas, e a propagacao
+  // para em cada porta cuja saida nao mudou (ver Netlist::resimular)
+  // Se Ctx nao contiver uma simulacao anterior, faz uma simulacao completa
+  // Retorna true se a simulacao foi OK; false caso deh erro
+  bool resimular(const std::vector<bool3S> &in_circ, const std::vector<int> &IdsAlterados,
+                 ContextoSimulacao &Ctx) const;
+
+  // Simula o circuito para 64 vetores de entrada de uma soh vez (ver palavra3S.h)
+  // in_circ tem dimensao igual ao numero de entradas do circuito: o B-esimo bit
+  // de in_circ[i] eh o valor da entrada i no B-esimo vetor
+  // out_lote recebe as saidas do circuito da mesma forma (dimensao igual ao
+  // numero de saidas). Nao altera out_circ.
+  // Retorna true se a simulacao foi OK; false caso deh erro
+  bool simular(const std::vector<Palavra3S> &in_circ, std::vector<Palavra3S> &out_lote) const;
+
+  // Depois de uma simulacao com o contexto Ctx, preenche Lacos com os lacos de
+  // realimentacao em que alguma porta ficou indefinida (ver Netlist::diagnosticarLacos),
+  // com as ids das portas no circuito
+  // Retorna false se Ctx nao contiver uma simulacao deste circuito
+  bool diagnosticarLacos(const ContextoSimulacao &Ctx, std::vector<DiagnosticoLaco> &Lacos) const;
 };
 
 // Operador de impressao da classe Circuit
@@ -0,0 +1,145 @@
+#include <cctype>
+#include <fstream>
+#include <vector>
+#include "codigo.h"
+#include "netlist.h"
+#include "instrumentacao.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+using namespace std;
+
+// O nome da variavel do codigo gerado que guarda o sinal S da netlist N:
+// "e<i>" para a entrada de id -(i+1) e "p<id>" para a saida da porta de id <id>
+static string variavel(const Netlist &N, uint32_t S)
+{
+  int id = N.idOrig(S);
+  return (id < 0 ? "e" + to_string(-id - 1) : "p" + to_string(id));
+}
+
+// A expressao que calcula a saida da K-esima porta da netlist N
+static string expressao(const Netlist &N, unsigned K)
+{
+  static const char *operador[] = {"", " & ", " & ", " | ", " | ", " ^ ", " ^ "};
+  TipoPorta T = N.getTipo(K);
+  const uint32_t *f = N.getFanin(K);
+  string expr;
+
+  for (unsigned j = 0; j < N.getNumInputsPort(K); j++)
+  {
+    if (j > 0)
+      expr += operador[int(T)];
+    expr += variavel(N, f[j]);
+  }
+  if (T == TipoPorta::NT)
+    return "~" + expr;
+  if (T == TipoPorta::NA || T == TipoPorta::NO || T == TipoPorta::NX)
+    return "~(" + expr + ")";
+  return expr;
+}
+
+bool gerarCodigo(const Circuito &C, std::ostream &O, const std::string &Nome)
+{
+  if (!C.valid())
+    return false;
+
+  const Netlist &N = C.getNetlist();
+  unsigned NI = N.getNumInputs();
+  unsigned NO = N.getNumOutputs();
+  unsigned NP = N.getNumPorts();
+  unsigned NA = N.getNumAciclicas();
+
+  string guarda = "_" + Nome + "_H_";
+  for (char &c : guarda)
+    c = toupper(c);
+
+  O << "// Simulacao do circuito " << Nome << " (" << NI << " entradas, " << NO
+    << " saidas, " << NP << " portas)\n";
+  O << "// Gerado automaticamente (ver codigo.h): nao deve ser alterado\n\n";
+  O << "#ifndef " << guarda << "\n#define " << guarda << "\n\n";
+  O << "#include <array>\n#include \"bool3S.h\"\n\n";
+  O << "namespace " << Nome << "\n{\n";
+  O << "const unsigned NUM_ENTRADAS = " << NI << ";\n";
+  O << "const unsigned NUM_SAIDAS = " << NO << ";\n\n";
+  O << "template <class V = bool3S>\n";
+  O << "constexpr std::array<V, NUM_SAIDAS> simular(const std::array<V, NUM_ENTRADAS> &in_circ)\n{\n";
+
+  // Os sinais que nao alimentam nenhuma porta nem saida sao marcados, para que o
+  // compilador nao avise que nao sao usados
+  vector<bool> usado(N.getNumSinais(), false);
+  for (uint32_t S = 0; S < N.getNumSinais(); S++)
+    usado[S] = N.getNumFanout(S) > 0;
+  for (unsigned j = 0; j < NO; j++)
+    usado[N.getSaida(j)] = true;
+  auto constante = [&](uint32_t S)
+  { return string(usado[S] ? "  const V " : "  [[maybe_unused]] const V ") + variavel(N, S); };
+
+  for (unsigned i = 0; i < NI; i++)
+    O << constante(i) << " = in_circ[" << i << "];\n";
+
+  // Parte aciclica: uma constante por porta, na ordem de simulacao
+  unsigned nivel = ~0u;
+  for (unsigned k = 0; k < NA; k++)
+  {
+    if (N.getNivel(k) != nivel)
+    {
+      nivel = N.getNivel(k);
+      O << "  // Nivel " << nivel << "\n";
+    }
+    O << constante(NI + k) << " = " << expressao(N, k) << ";\n";
+  }
+
+  // Parte com realimentacao: ponto fixo a partir de UNDEF
+  if (NA < NP)
+  {
+    O << "  // Lacos de realimentacao: repete ateh que nenhuma porta mude\n";
+    for (unsigned k = NA; k < NP; k++)
+      O << "  V " << variavel(N, NI + k) << "{};\n";
+    O << "  bool mudou = true;\n";
+    O << "  while (mudou)\n  {\n";
+    O << "    mudou = false;\n";
+    for (unsigned k = NA; k < NP; k++)
+    {
+      string v = variavel(N, NI + k);
+      O << "    {\n";
+      O << "      const V novo = " << expressao(N, k) << ";\n";
+      O << "      mudou = mudou || novo != " << v << ";\n";
+      O << "      " << v << " = novo;\n";
+      O << "    }\n";
+    }
+    O << "  }\n";
+  }
+
+  O << "  return std::array<V, NUM_SAIDAS>{";
+  for (unsigned j = 0; j < NO; j++)
+    O << (j > 0 ? ", " : "") << variavel(N, N.getSaida(j));
+  O << "};\n";
+  O << "}\n";
+  O << "} // namespace " << Nome << "\n\n";
+  O << "#endif // " << guarda << "\n";
+  return true;
+}
+
+bool salvarCodigo(const Circuito &C, const std::string &arq)
+{
+  INSTR_FASE(SAIDA);
+  // O nome do namespace vem do nome do arquivo
+  size_t ini = arq.find_last_of("/\\");
+  ini = (ini == string::npos ? 0 : ini + 1);
+  size_t fim = arq.find('.', ini);
+  string nome = arq.substr(ini, fim == string::npos ? string::npos : fim - ini);
+  for (char &c : nome)
+    if (!isalnum((unsigned char)c))
+      c = '_';
+  if (nome.empty() || isdigit((unsigned char)nome[0]))
+    nome = "circuito_" + nome;
+
+  ofstream arquivo(arq);
+  if (!arquivo.is_open())
+    return false;
+  if (!gerarCodigo(C, arquivo, nome))
+    return false;
+  arquivo.close();
+  return !arquivo.fail();
+}
@@ -0,0 +1,39 @@
+#ifndef _CODIGO_H_
+#define _CODIGO_H_
+
+#include <iostream>
+#include <string>
+#include "circuito.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// GERACAO DE CODIGO C++ PARA UM CIRCUITO FIXO
+/// Gera um cabecalho C++ com a simulacao de um circuito especifico, para ser
+/// incluido diretamente em outro programa: uma funcao constexpr, sem vetores
+/// dinamicos nem funcoes virtuais, com uma variavel para cada sinal e uma
+/// expressao para cada porta, na ordem de simulacao da netlist (por niveis).
+/// A funcao gerada eh um template no tipo dos valores: com bool3S, simula um
+/// vetor de entradas (podendo ser avaliada em tempo de compilacao); com
+/// Palavra3S, simula 64 vetores de uma soh vez.
+/// As portas em lacos de realimentacao sao simuladas por um laco do tipo
+/// "repita enquanto mudar", partindo de UNDEF (o mesmo ponto fixo da netlist).
+/// O codigo gerado soh depende de bool3S.h (e de palavra3S.h, se usado com
+/// Palavra3S). Ver tambem dsl3S.h, para descrever circuitos direto em C++.
+/// ###########################################################################
+
+// Escreve em O o cabecalho C++ com a simulacao do circuito C, dentro do namespace Nome
+// (que deve ser um identificador C++ valido). O cabecalho define:
+//   Nome::NUM_ENTRADAS, Nome::NUM_SAIDAS
+//   template <class V = bool3S>
+//   constexpr std::array<V, NUM_SAIDAS> Nome::simular(const std::array<V, NUM_ENTRADAS> &in_circ)
+// Retorna true se deu tudo OK; false se o circuito for invalido
+bool gerarCodigo(const Circuito &C, std::ostream &O, const std::string &Nome);
+
+// Idem, gravando no arquivo arq. O namespace tem o nome do arquivo (sem diretorio
+// nem extensao), trocando por '_' os caracteres que nao podem estar em um identificador
+// Retorna true se deu tudo OK; false se deu erro
+bool salvarCodigo(const Circuito &C, const std::string &arq);
+
+#endif // _CODIGO_H_
@@ -0,0 +1,784 @@
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include "comandos.h"
+#include "circuito.h"
+#include "netlist.h"
+#include "binario.h"
+#include "tabela.h"
+#include "lote.h"
+#include "codigo.h"
+#include "gerador.h"
+#include "instrumentacao.h"
+#include "otimizador.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+using namespace std;
+
+///
+/// ARGUMENTOS DOS COMANDOS
+///
+
+namespace
+{
+// Os argumentos de um comando, jah separados
+struct Argumentos
+{
+  // Os argumentos posicionais (arquivos), na ordem
+  vector<string> arquivos;
+  // As opcoes, com o seu valor ("" para as opcoes sem valor)
+  map<string, string> opcoes;
+
+  bool tem(const string &Opcao) const { return opcoes.count(Opcao) > 0; }
+  string valor(const string &Opcao, const string &Padrao = "") const
+  {
+    auto it = opcoes.find(Opcao);
+    return (it != opcoes.end() ? it->second : Padrao);
+  }
+};
+
+// Descricao de um comando
+struct Comando
+{
+  const char *nome;
+  unsigned Narquivos;    // numero de argumentos posicionais
+  const char *com_valor; // opcoes que recebem um valor, separadas por espacos
+  const char *sem_valor; // opcoes sem valor, separadas por espacos
+  const char *uso;       // descricao dos argumentos e das opcoes
+  int (*executar)(const Argumentos &A);
+};
+} // namespace
+
+// Retorna true se Opcao eh uma das palavras da Lista (separadas por espacos)
+static bool naLista(const string &Opcao, const char *Lista)
+{
+  string L = string(" ") + Lista + " ";
+  return L.find(" " + Opcao + " ") != string::npos;
+}
+
+// Opcoes que valem para todos os comandos
+static const char *OPCOES_GERAIS = "--relatorio";
+
+// Separa os argumentos argv[2] .. argv[argc-1] do comando Cmd em A
+// Retorna false (e imprime a mensagem em cerr) se algum argumento for invalido
+static bool separarArgumentos(const Comando &Cmd, int argc, char *argv[], Argumentos &A)
+{
+  for (int i = 2; i < argc; i++)
+  {
+    string arg = argv[i];
+    if (arg.size() < 2 || arg[0] != '-')
+      A.arquivos.push_back(arg);
+    else if (naLista(arg, Cmd.com_valor) || naLista(arg, OPCOES_GERAIS))
+    {
+      if (i + 1 >= argc)
+      {
+        cerr << "Opcao " << arg << " sem valor\n";
+        return false;
+      }
+      A.opcoes[arg] = argv[++i];
+    }
+    else if (naLista(arg, Cmd.sem_valor))
+      A.opcoes[arg] = "";
+    else
+    {
+      cerr << "Opcao invalida para o comando " << Cmd.nome << ": " << arg << "\n";
+      return false;
+    }
+  }
+  if (A.arquivos.size() != Cmd.Narquivos)
+  {
+    cerr << "O comando " << Cmd.nome << " precisa de " << Cmd.Narquivos << " arquivo(s)\n";
+    return false;
+  }
+  return true;
+}
+
+// Converte o valor da opcao Opcao de A (ou Padrao, se nao houver) para N
+// Retorna false (e imprime a mensagem em cerr) se o valor nao for um inteiro >= 0
+template <class T>
+static bool valorNumerico(const Argumentos &A, const string &Opcao, T Padrao, T &N)
+{
+  N = Padrao;
+  if (!A.tem(Opcao))
+    return true;
+  string V = A.valor(Opcao);
+  auto r = from_chars(V.data(), V.data() + V.size(), N);
+  if (r.ec != errc() || r.ptr != V.data() + V.size())
+  {
+    cerr << "Valor invalido para a opcao " << Opcao << ": " << V << "\n";
+    return false;
+  }
+  return true;
+}
+
+// Idem, para um valor real entre 0 e 1
+static bool valorFracao(const Argumentos &A, const string &Opcao, double &X)
+{
+  if (!A.tem(Opcao))
+    return true;
+  string V = A.valor(Opcao);
+  auto r = from_chars(V.data(), V.data() + V.size(), X);
+  if (r.ec != errc() || r.ptr != V.data() + V.size() || X < 0.0 || X > 1.0)
+  {
+    cerr << "Valor invalido para a opcao " << Opcao << " (de 0 a 1): " << V << "\n";
+    return false;
+  }
+  return true;
+}
+
+// Converte o valor da opcao Opcao de A para um formato de lote (texto ou binario)
+static bool valorFormato(const Argumentos &A, const string &Opcao, FormatoLote &F)
+{
+  string V = A.valor(Opcao, "texto");
+  if (V != "texto" && V != "binario")
+  {
+    cerr << "Formato invalido para a opcao " << Opcao << " (texto ou binario): " << V << "\n";
+    return false;
+  }
+  F = (V == "texto" ? FormatoLote::TEXTO : FormatoLote::BINARIO);
+  return true;
+}
+
+// Leh o circuito do arquivo arq, no formato texto ou binario (reconhecido pelos
+// primeiros bytes do arquivo, ver MAGICA_BINARIO)
+// Retorna false (e imprime a mensagem em cerr) se deu erro
+static bool lerCircuito(const string &arq, Circuito &C)
+{
+  char magica[sizeof(MAGICA_BINARIO)] = {0};
+  {
+    ifstream arquivo(arq, ios::binary);
+    if (!arquivo.is_open())
+    {
+      cerr << "Arquivo " << arq << " invalido para leitura\n";
+      return false;
+    }
+    arquivo.read(magica, sizeof(magica));
+  }
+  bool binario = (memcmp(magica, MAGICA_BINARIO, sizeof(magica)) == 0);
+  if (!(binario ? C.lerBinario(arq) : C.ler(arq)))
+  {
+    cerr << "Arquivo " << arq << " invalido para leitura\n";
+    return false;
+  }
+  return true;
+}
+
+// O formato do circuito a gravar no arquivo saida: o da opcao --formato de A ou,
+// sem ela, o da extensao (.cbin: binario, .h ou .hpp: cabecalho C++, demais: texto)
+// Retorna "" (e imprime a mensagem em cerr) se o formato for invalido
+static string formatoCircuito(const Argumentos &A, const string &saida)
+{
+  auto terminaCom = [&saida](const string &Ext)
+  { return saida.size() >= Ext.size() && saida.compare(saida.size() - Ext.size(), Ext.size(), Ext) == 0; };
+
+  string formato = A.valor("--formato", terminaCom(".cbin")                       ? "binario"
+                                        : terminaCom(".h") || terminaCom(".hpp") ? "cpp"
+                                                                                 : "texto");
+  if (formato != "texto" && formato != "binario" && formato != "cpp")
+  {
+    cerr << "Formato invalido (texto, binario ou cpp): " << formato << "\n";
+    return "";
+  }
+  return formato;
+}
+
+// Grava o circuito C no arquivo saida, no formato dado por formatoCircuito
+// Retorna false (e imprime a mensagem em cerr) se deu erro
+static bool gravarCircuito(const Circuito &C, const string &saida, const string &formato)
+{
+  bool ok = (formato == "texto"     ? C.salvar(saida)
+             : formato == "binario" ? C.salvarBinario(saida)
+                                    : salvarCodigo(C, saida));
+  if (!ok)
+    cerr << "Arquivo " << saida << " invalido para escrita\n";
+  return ok;
+}
+
+///
+/// OS COMANDOS
+///
+
+static int comandoTable(const Argumentos &A)
+{
+  Circuito C;
+  unsigned NThreads;
+  if (!valorNumerico(A, "--threads", 0u, NThreads))
+    return 2;
+  if (A.tem("--binario") && !A.tem("-o"))
+  {
+    cerr << "A tabela binaria precisa de um arquivo de saida (-o)\n";
+    return 2;
+  }
+  bool gray = A.tem("--gray") || A.tem("--ordem-gray");
+  if (gray && A.tem("--binario"))
+  {
+    cerr << "A tabela em codigo de Gray nao pode ser gravada no formato binario\n";
+    return 2;
+  }
+  if (!lerCircuito(A.arquivos[0], C))
+    return 1;
+  if (C.getNumInputs() > MAX_ENTRADAS_TABELA)
+  {
+    cerr << "Circuito com entradas demais para a tabela verdade\n";
+    return 1;
+  }
+
+  if (gray && !A.tem("--ordem-gray") &&
+      numLinhasTabela(C.getNumInputs()) > MAX_MEMORIA_TABELA_GRAY / C.getNumOutputs())
+  {
+    cerr << "Tabela grande demais para a ordem canonica com --gray: use --ordem-gray\n";
+    return 1;
+  }
+
+  // A tabela em codigo de Gray (simulacao incremental) ou em paralelo
+  auto gerar = [&](ostream &O)
+  { return (gray ? gerarTabelaGray(C, O, !A.tem("--ordem-gray")) : gerarTabela(C, O, NThreads)); };
+  bool ok;
+  if (A.tem("--binario"))
+    ok = salvarTabelaBinaria(C, A.valor("-o"), NThreads);
+  else if (A.tem("-o"))
+  {
+    ofstream arquivo(A.valor("-o"));
+    ok = arquivo.is_open() && gerar(arquivo) && arquivo.good();
+  }
+  else
+    ok = gerar(cout);
+  if (!ok)
+  {
+    cerr << "Erro ao gerar a tabela verdade\n";
+    return 1;
+  }
+  return 0;
+}
+
+static int comandoSimulate(const Argumentos &A)
+{
+  Circuito C;
+  unsigned NThreads, VetoresLote;
+  FormatoLote FormatoIn, FormatoOut;
+  if (!valorNumerico(A, "--threads", 1u, NThreads) ||
+      !valorNumerico(A, "--lote", VETORES_LOTE, VetoresLote) ||
+      !valorFormato(A, "--entrada", FormatoIn) || !valorFormato(A, "--saida", FormatoOut))
+    return 2;
+  if (!lerCircuito(A.arquivos[0], C))
+    return 1;
+
+  // Sem -i ou -o (ou com "-"), usa cin e cout
+  ifstream arq_in;
+  ofstream arq_out;
+  string nome_in = A.valor("-i", "-"), nome_out = A.valor("-o", "-");
+  if (nome_in != "-")
+  {
+    arq_in.open(nome_in, ios::binary);
+    if (!arq_in.is_open())
+    {
+      cerr << "Arquivo " << nome_in << " invalido para leitura\n";
+      return 1;
+    }
+  }
+  if (nome_out != "-")
+  {
+    arq_out.open(nome_out, ios::binary);
+    if (!arq_out.is_open())
+    {
+      cerr << "Arquivo " << nome_out << " invalido para escrita\n";
+      return 1;
+    }
+  }
+
+  uint64_t Nvetores;
+  if (!simularLote(C, (nome_in != "-" ? arq_in : cin), (nome_out != "-" ? arq_out : cout),
+                   FormatoIn, FormatoOut, Nvetores, VetoresLote, NThreads))
+  {
+    cerr << "Simulacao interrompida apos " << Nvetores << " vetores\n";
+    return 1;
+  }
+  return 0;
+}
+
+static int comandoConvert(const Argumentos &A)
+{
+  Circuito C;
+  string formato = formatoCircuito(A, A.arquivos[1]);
+  if (formato.empty())
+    return 2;
+  if (!lerCircuito(A.arquivos[0], C))
+    return 1;
+  return (gravarCircuito(C, A.arquivos[1], formato) ? 0 : 1);
+}
+
+static int comandoOptimize(const Argumentos &A)
+{
+  Circuito C, otimizado;
+  EstatisticasOtimizacao E;
+  string formato = formatoCircuito(A, A.arquivos[1]);
+  if (formato.empty())
+    return 2;
+  if (!lerCircuito(A.arquivos[0], C))
+    return 1;
+  if (!otimizarCircuito(C, otimizado, &E))
+  {
+    cerr << "Erro ao otimizar o circuito\n";
+    return 1;
+  }
+  if (!gravarCircuito(otimizado, A.arquivos[1], formato))
+    return 1;
+
+  cout << "Portas: " << E.portas_antes << " -> " << E.portas_depois << "\n";
+  cout << "Duplicadas: " << E.duplicadas << "\n";
+  cout << "NOT de NOT: " << E.negacoes_duplas << "\n";
+  cout << "Entradas repetidas: " << E.entradas_repetidas << " (" << E.fios
+       << " portas ficaram com uma entrada)\n";
+  cout << "Sem ligacao com as saidas: " << E.mortas << "\n";
+  return 0;
+}
+
+static int comandoSpecialize(const Argumentos &A)
+{
+  Circuito C, especializado;
+  EstatisticasOtimizacao E;
+  vector<int> entradas;
+  string formato = formatoCircuito(A, A.arquivos[1]);
+  if (formato.empty())
+    return 2;
+  if (!lerCircuito(A.arquivos[0], C))
+    return 1;
+
+  // Um caractere por entrada: F, T ou ? (livre)
+  string V = A.valor("--fixas");
+  vector<bool3S> fixas;
+  for (char c : V)
+  {
+    fixas.push_back(toBool3S(c));
+    if (fixas.back() == bool3S::UNDEF && c != '?')
+    {
+      cerr << "Valor invalido para a opcao --fixas (F, T ou ? para cada entrada): " << V << "\n";
+      return 2;
+    }
+  }
+  if (fixas.size() != C.getNumInputs())
+  {
+    cerr << "A opcao --fixas precisa de " << C.getNumInputs() << " valores (um por entrada)\n";
+    return 2;
+  }
+
+  if (!especializarCircuito(C, fixas, especializado, entradas, &E))
+  {
+    cerr << "Erro ao especializar o circuito\n";
+    return 1;
+  }
+  if (!gravarCircuito(especializado, A.arquivos[1], formato))
+    return 1;
+
+  cout << "Portas: " << E.portas_antes << " -> " << E.portas_depois << "\n";
+  cout << "Constantes: " << E.constantes << "\n";
+  cout << "Entradas do circuito especializado:\n";
+  for (size_t i = 0; i < entradas.size(); i++)
+  {
+    cout << "  " << i + 1 << " <- entrada " << -entradas[i];
+    if (fixas[-entradas[i] - 1] != bool3S::UNDEF)
+      cout << " (fixa: deve receber " << toChar(fixas[-entradas[i] - 1]) << ")";
+    cout << "\n";
+  }
+  return 0;
+}
+
+static int comandoDiff(const Argumentos &A)
+{
+  TabelaBinaria T1, T2;
+  uint64_t MaxImpressas, Ndif;
+  if (!valorNumerico(A, "--max", uint64_t(20), MaxImpressas))
+    return 2;
+  for (unsigned t = 0; t < 2; t++)
+  {
+    if (!(t == 0 ? T1 : T2).abrir(A.arquivos[t]))
+    {
+      cerr << "Arquivo " << A.arquivos[t] << " invalido para leitura\n";
+      return 1;
+    }
+  }
+  if (!compararTabelas(T1, T2, Ndif, cout, MaxImpressas))
+    return 1;
+  // Como o diff: 0 se as tabelas sao iguais, 1 se sao diferentes
+  return (Ndif == 0 ? 0 : 1);
+}
+
+static int comandoBench(const Argumentos &A)
+{
+  Circuito C;
+  uint64_t Nvetores;
+  unsigned NThreads;
+  if (!valorNumerico(A, "--vetores", uint64_t(1) << 20, Nvetores) ||
+      !valorNumerico(A, "--threads", 0u, NThreads))
+    return 2;
+  if (Nvetores == 0)
+  {
+    cerr << "Valor invalido para a opcao --vetores: deve ser maior que 0\n";
+    return 2;
+  }
+  if (!lerCircuito(A.arquivos[0], C))
+    return 1;
+
+  // A compilacao fica fora da medicao
+  const Netlist &N = C.getNetlist();
+  uint64_t Nblocos = (Nvetores + BITS_BLOCO3S - 1) / BITS_BLOCO3S;
+  if (NThreads == 0)
+    NThreads = thread::hardware_concurrency();
+  if (NThreads == 0)
+    NThreads = 1;
+  if (NThreads > Nblocos)
+    NThreads = Nblocos;
+
+  // Cada thread simula uma parte dos blocos, com entradas pseudoaleatorias (xorshift)
+  auto trabalhar = [&](unsigned t)
+  {
+    vector<Bloco3S> in_circ(N.getNumInputs()), valores(N.getNumSinais());
+    uint64_t x = 0x9e3779b97f4a7c15ULL * (t + 1);
+    auto aleatorio = [&x]()
+    {
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+      return x;
+    };
+    for (uint64_t b = Nblocos * t / NThreads; b < Nblocos * (t + 1) / NThreads; b++)
+    {
+      for (Bloco3S &B : in_circ)
+        for (unsigned w = 0; w < PALAVRAS_BLOCO3S; w++)
+        {
+          B.t[w] = aleatorio();
+          B.f[w] = ~B.t[w] & aleatorio();
+        }
+      N.simular(in_circ.data(), valores.data());
+    }
+  };
+
+  auto t0 = chrono::steady_clock::now();
+  if (NThreads <= 1)
+    trabalhar(0);
+  else
+  {
+    vector<thread> threads;
+    for (unsigned t = 0; t < NThreads; t++)
+      threads.emplace_back(trabalhar, t);
+    for (unsigned t = 0; t < NThreads; t++)
+      threads[t].join();
+  }
+  double seg = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+  uint64_t Nsimulados = Nblocos * BITS_BLOCO3S;
+  cout << "Circuito: " << N.getNumInputs() << " entradas, " << N.getNumOutputs() << " saidas, "
+       << N.getNumPorts() << " portas\n";
+  cout << "Simulados: " << Nsimulados << " vetores em " << seg << " s (" << NThreads
+       << " thread(s))\n";
+  if (seg > 0.0)
+    cout << "Vazao: " << Nsimulados / seg << " vetores/s, " << Nsimulados * double(N.getNumPorts()) / seg
+         << " portas/s\n";
+  return 0;
+}
+
+static int comandoStats(const Argumentos &A)
+{
+  Circuito C;
+  if (!lerCircuito(A.arquivos[0], C))
+    return 1;
+
+  const Netlist &N = C.getNetlist();
+  unsigned NP = N.getNumPorts();
+  unsigned Ntipo[int(TipoPorta::NX) + 1] = {0};
+  uint64_t fanin_total = 0;
+  unsigned fanin_max = 0, fanout_max = 0;
+  for (unsigned k = 0; k < NP; k++)
+  {
+    Ntipo[int(N.getTipo(k))]++;
+    fanin_total += N.getNumInputsPort(k);
+    fanin_max = max(fanin_max, N.getNumInputsPort(k));
+  }
+  for (uint32_t S = 0; S < N.getNumSinais(); S++)
+    fanout_max = max(fanout_max, N.getNumFanout(S));
+
+  cout << "Entradas: " << N.getNumInputs() << "\n";
+  cout << "Saidas: " << N.getNumOutputs() << "\n";
+  cout << "Portas: " << NP << " (";
+  for (int T = 0; T <= int(TipoPorta::NX); T++)
+    cout << (T > 0 ? ", " : "") << toSigla(TipoPorta(T)) << " " << Ntipo[T];
+  cout << ")\n";
+  cout << "Fan-in: " << fanin_total << " entradas de portas (media " << double(fanin_total) / NP
+       << ", maximo " << fanin_max << ")\n";
+  cout << "Fan-out maximo: " << fanout_max << "\n";
+  cout << "Parte aciclica: " << N.getNumAciclicas() << " portas em " << N.getNumNiveis() << " niveis\n";
+  cout << "Parte com realimentacao: " << NP - N.getNumAciclicas() << " portas\n";
+  if (N.getNumAciclicas() == NP)
+    return 0;
+
+  // Os lacos (componentes fortemente conexas) da parte com realimentacao
+  unsigned Nlacos = 0, portas_lacos = 0, maior_laco = 0;
+  for (unsigned s = 0; s < N.getNumSegmentos(); s++)
+  {
+    if (!N.segmentoLaco(s))
+      continue;
+    Nlacos++;
+    portas_lacos += N.getNumPortsSegmento(s);
+    maior_laco = max(maior_laco, N.getNumPortsSegmento(s));
+  }
+  cout << "Lacos: " << Nlacos << " (" << portas_lacos << " portas, o maior com " << maior_laco
+       << "); " << NP - N.getNumAciclicas() - portas_lacos << " portas dependem de lacos\n";
+
+  // Diagnostico: simulacao com vetores de entrada aleatorios (todos definidos),
+  // contando as avaliacoes ateh o ponto fixo e os lacos que ficaram indefinidos
+  const unsigned AMOSTRAS = 16;
+  vector<bool3S> in_circ(N.getNumInputs());
+  vector<DiagnosticoLaco> lacos;
+  vector<unsigned> indefinido(N.getNumSegmentos(), 0);
+  uint64_t avaliacoes = 0, x = 0x9e3779b97f4a7c15ULL;
+  for (unsigned a = 0; a < AMOSTRAS; a++)
+  {
+    for (bool3S &v : in_circ)
+    {
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+      v = (x & 1 ? bool3S::TRUE : bool3S::FALSE);
+    }
+    ContextoSimulacao Ctx;
+    C.simular(in_circ, Ctx);
+    avaliacoes += Ctx.getAvaliacoesLacos();
+    C.diagnosticarLacos(Ctx, lacos);
+    for (const DiagnosticoLaco &L : lacos)
+      indefinido[L.segmento] = max(indefinido[L.segmento], L.Nindefinidas);
+  }
+  cout << "Avaliacoes na parte com realimentacao: " << double(avaliacoes) / AMOSTRAS
+       << " por simulacao (" << double(avaliacoes) / AMOSTRAS / (NP - N.getNumAciclicas())
+       << " por porta), em " << AMOSTRAS << " vetores aleatorios\n";
+  unsigned Nindefinidos = 0;
+  for (unsigned s = 0; s < N.getNumSegmentos(); s++)
+    Nindefinidos += (indefinido[s] > 0);
+  cout << "Lacos indefinidos com entradas definidas: " << Nindefinidos << "\n";
+  for (unsigned s = 0, impressos = 0; s < N.getNumSegmentos() && impressos < 10; s++)
+  {
+    if (indefinido[s] == 0)
+      continue;
+    cout << "  laco com " << N.getNumPortsSegmento(s) << " portas (porta " << N.getIdPort(N.getInicioSegmento(s))
+         << "): ateh " << indefinido[s] << " portas indefinidas\n";
+    impressos++;
+  }
+  return 0;
+}
+
+static int comandoGenerate(const Argumentos &A)
+{
+  ParametrosGerador P;
+  const string &saida = A.arquivos[0];
+  if (!valorNumerico(A, "--entradas", P.Nin, P.Nin) ||
+      !valorNumerico(A, "--saidas", P.Nout, P.Nout) ||
+      !valorNumerico(A, "--portas", P.Nportas, P.Nportas) ||
+      !valorNumerico(A, "--janela", P.janela, P.janela) ||
+      !valorNumerico(A, "--niveis", P.niveis, P.niveis) ||
+      !valorNumerico(A, "--semente", P.semente, P.semente) ||
+      !valorFracao(A, "--frac-entradas", P.frac_entradas) ||
+      !valorFracao(A, "--realimentacao", P.frac_realimentacao))
+    return 2;
+
+  // --fanin MIN-MAX
+  if (A.tem("--fanin"))
+  {
+    string V = A.valor("--fanin");
+    const char *fim = V.data() + V.size();
+    auto r1 = from_chars(V.data(), fim, P.fanin_min);
+    auto r2 = (r1.ec == errc() && r1.ptr < fim && *r1.ptr == '-'
+                   ? from_chars(r1.ptr + 1, fim, P.fanin_max)
+                   : from_chars_result{fim, errc::invalid_argument});
+    if (r2.ec != errc() || r2.ptr != fim)
+    {
+      cerr << "Valor invalido para a opcao --fanin (MIN-MAX): " << V << "\n";
+      return 2;
+    }
+  }
+  // --distribuicao uniforme|geometrica[:MEDIA]
+  if (A.tem("--distribuicao"))
+  {
+    string V = A.valor("--distribuicao");
+    if (V == "uniforme")
+      P.distribuicao = DistribuicaoFanin::UNIFORME;
+    else if (V.compare(0, 10, "geometrica") == 0 &&
+             (V.size() == 10 ||
+              (V[10] == ':' &&
+               from_chars(V.data() + 11, V.data() + V.size(), P.fanin_media).ptr == V.data() + V.size())))
+      P.distribuicao = DistribuicaoFanin::GEOMETRICA;
+    else
+    {
+      cerr << "Valor invalido para a opcao --distribuicao (uniforme ou geometrica[:MEDIA]): "
+           << V << "\n";
+      return 2;
+    }
+  }
+  // --tipos XX=PESO,XX=PESO,...: os tipos que nao aparecem ficam com peso 0
+  if (A.tem("--tipos"))
+  {
+    string V = A.valor("--tipos") + ",";
+    for (unsigned T = 0; T <= unsigned(TipoPorta::NX); T++)
+      P.peso_tipo[T] = 0;
+    for (size_t ini = 0, fim; (fim = V.find(',', ini)) != string::npos; ini = fim + 1)
+    {
+      string item = V.substr(ini, fim - ini);
+      size_t igual = item.find('=');
+      TipoPorta T;
+      if (igual == string::npos || !toTipoPorta(item.substr(0, igual), T) ||
+          from_chars(item.data() + igual + 1, item.data() + item.size(), P.peso_tipo[unsigned(T)]).ptr !=
+              item.data() + item.size())
+      {
+        cerr << "Valor invalido para a opcao --tipos (XX=PESO,...): " << item << "\n";
+        return 2;
+      }
+    }
+  }
+
+  bool binario = (A.valor("--formato", saida.size() >= 5 && saida.compare(saida.size() - 5, 5, ".cbin") == 0
+                                           ? "binario"
+                                           : "texto") == "binario");
+  if (const char *erro = erroParametros(P))
+  {
+    cerr << "Parametros invalidos: " << erro << "\n";
+    return 2;
+  }
+  if (!salvarCircuitoGerado(P, saida, binario))
+  {
+    cerr << "Arquivo " << saida << " invalido para escrita\n";
+    return 1;
+  }
+  return 0;
+}
+
+// Todos os comandos
+static const Comando COMANDOS[] = {
+    {"table", 1, "-o --threads", "--binario --gray --ordem-gray",
+     "table <circ> [-o arq] [--binario] [--threads N] [--gray | --ordem-gray]\n"
+     "    Gera a tabela verdade (em cout ou no arquivo); --binario: formato binario\n"
+     "    compactado (exige -o); --threads: 0 = uma por nucleo (padrao);\n"
+     "    --gray: simulacao incremental em codigo de Gray (uma thread), com as linhas\n"
+     "    na ordem de sempre; --ordem-gray: idem, com as linhas na ordem simulada",
+     comandoTable},
+    {"simulate", 1, "-i -o --entrada --saida --threads --lote", "",
+     "simulate <circ> [-i arq] [-o arq] [--entrada texto|binario] [--saida texto|binario]\n"
+     "         [--threads N] [--lote N]\n"
+     "    Simula os vetores de entrada (de cin ou do arquivo -i) e escreve as saidas\n"
+     "    (em cout ou no arquivo -o); --lote: vetores lidos de cada vez",
+     comandoSimulate},
+    {"convert", 2, "--formato", "",
+     "convert <circ> <saida> [--formato texto|binario|cpp]\n"
+     "    Converte o circuito; sem --formato, usa a extensao da saida (.cbin: binario,\n"
+     "    .h ou .hpp: cabecalho C++, demais: texto)",
+     comandoConvert},
+    {"optimize", 2, "--formato", "",
+     "optimize <circ> <saida> [--formato texto|binario|cpp]\n"
+     "    Grava o circuito otimizado (ver otimizador.h): sem portas duplicadas, NOT de\n"
+     "    NOT e portas sem ligacao com as saidas; o formato eh escolhido como em convert",
+     comandoOptimize},
+    {"specialize", 2, "--fixas --formato", "",
+     "specialize <circ> <saida> --fixas VALORES [--formato texto|binario|cpp]\n"
+     "    Grava o circuito especializado para as entradas fixas (ver otimizador.h):\n"
+     "    VALORES tem um caractere por entrada, F ou T (fixa) ou ? (livre); imprime\n"
+     "    de qual entrada original vem cada entrada do circuito especializado",
+     comandoSpecialize},
+    {"diff", 2, "--max", "",
+     "diff <tab1> <tab2> [--max N]\n"
+     "    Compara duas tabelas verdade binarias e imprime as N primeiras linhas\n"
+     "    diferentes (padrao 20); retorna 1 se as tabelas forem diferentes",
+     comandoDiff},
+    {"bench", 1, "--vetores --threads", "",
+     "bench <circ> [--vetores N] [--threads N]\n"
+     "    Simula N vetores aleatorios (padrao 1048576) e mede a vazao",
+     comandoBench},
+    {"generate", 1,
+     "--entradas --saidas --portas --tipos --fanin --distribuicao --frac-entradas --janela "
+     "--niveis --realimentacao --semente --formato",
+     "",
+     "generate <saida> [--entradas N] [--saidas N] [--portas N] [--tipos XX=PESO,...]\n"
+     "         [--fanin MIN-MAX] [--distribuicao uniforme|geometrica[:MEDIA]]\n"
+     "         [--frac-entradas X] [--janela N] [--niveis N] [--realimentacao X]\n"
+     "         [--semente N] [--formato texto|binario]\n"
+     "    Gera um circuito sintetico (ver gerador.h); padrao: 32 entradas, 16 saidas,\n"
+     "    1000 portas de todos os tipos com 2 a 4 entradas, aciclico; o formato vem\n"
+     "    da extensao da saida (.cbin: binario), se nao for dado",
+     comandoGenerate},
+    {"stats", 1, "", "",
+     "stats <circ>\n"
+     "    Imprime as caracteristicas do circuito",
+     comandoStats}};
+
+// Imprime a forma de uso de todos os comandos em O
+static void imprimirUso(ostream &O)
+{
+  O << "Uso: circuito <comando> [opcoes]\n"
+    << "     circuito (sem argumentos): menu interativo\n\nComandos:\n";
+  for (const Comando &Cmd : COMANDOS)
+    O << "  " << Cmd.uso << "\n";
+  O << "Opcoes de todos os comandos:\n"
+    << "  --relatorio arq\n"
+    << "    Grava o relatorio da instrumentacao (ver instrumentacao.h) ao final do\n"
+    << "    comando, em CSV se arq terminar com .csv ou em JSON; soh tem dados se o\n"
+    << "    programa foi compilado com CIRCUITO_INSTRUMENTACAO\n";
+}
+
+// Grava o relatorio da instrumentacao no arquivo arq (CSV ou JSON, pela extensao)
+// Retorna false (e imprime a mensagem em cerr) se deu erro
+static bool gravarRelatorio(const string &arq)
+{
+  bool csv = arq.size() >= 4 && arq.compare(arq.size() - 4, 4, ".csv") == 0;
+  if (!instrumentacaoAtiva())
+    cerr << "Aviso: instrumentacao nao compilada (CIRCUITO_INSTRUMENTACAO): relatorio zerado\n";
+  ofstream arquivo(arq);
+  if (!arquivo.is_open())
+  {
+    cerr << "Arquivo " << arq << " invalido para escrita\n";
+    return false;
+  }
+  relatorioInstrumentacao(arquivo, csv ? FormatoRelatorio::CSV : FormatoRelatorio::JSON);
+  return arquivo.good();
+}
+
+int executarComando(int argc, char *argv[])
+{
+  if (argc < 2)
+  {
+    imprimirUso(cerr);
+    return 2;
+  }
+  string nome = argv[1];
+  if (nome == "help" || nome == "--help" || nome == "-h")
+  {
+    imprimirUso(cout);
+    return 0;
+  }
+
+  // Os resultados podem ser grandes (tabelas, simulacao em lote): cin e cout nao
+  // precisam ficar sincronizados com stdio
+  ios::sync_with_stdio(false);
+
+  for (const Comando &Cmd : COMANDOS)
+  {
+    if (nome != Cmd.nome)
+      continue;
+    Argumentos A;
+    if (!separarArgumentos(Cmd, argc, argv, A))
+    {
+      cerr << "Uso: circuito " << Cmd.uso << "\n";
+      return 2;
+    }
+    int codigo = Cmd.executar(A);
+    if (A.tem("--relatorio") && !gravarRelatorio(A.valor("--relatorio")) && codigo == 0)
+      codigo = 1;
+    return codigo;
+  }
+  cerr << "Comando invalido: " << nome << "\n\n";
+  imprimirUso(cerr);
+  return 2;
+}
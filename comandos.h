@@ -0,0 +1,31 @@
+#ifndef _COMANDOS_H_
+#define _COMANDOS_H_
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// INTERFACE DE LINHA DE COMANDO
+/// Permite usar o simulador sem o menu interativo (em scripts, pipelines e
+/// medicoes de desempenho):
+///   circuito <comando> [opcoes] <arquivos>
+/// Comandos:
+///   table <circ>     gera a tabela verdade
+///   simulate <circ>  simula os vetores de entrada de um arquivo ou de cin (ver lote.h)
+///   convert <circ> <saida>  converte o circuito para outro formato
+///   optimize <circ> <saida> grava o circuito otimizado (ver otimizador.h)
+///   specialize <circ> <saida> grava o circuito especializado para entradas fixas
+///   diff <tab1> <tab2>      compara duas tabelas verdade binarias (ver tabela.h)
+///   bench <circ>     mede o desempenho da simulacao com vetores aleatorios
+///   generate <saida> gera um circuito sintetico (ver gerador.h)
+///   stats <circ>     imprime as caracteristicas do circuito
+/// Os circuitos podem estar no formato texto ou binario (reconhecido pelo conteudo).
+/// As opcoes de cada comando sao descritas em "circuito help".
+/// ###########################################################################
+
+// Executa o comando dado pelos argumentos do programa (argv[1] eh o comando)
+// Retorna o codigo de saida do programa: 0 se deu tudo OK, 1 se deu erro na
+// execucao, 2 se os argumentos forem invalidos
+int executarComando(int argc, char *argv[]);
+
+#endif // _COMANDOS_H_
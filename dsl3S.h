@@ -0,0 +1,96 @@
+#ifndef _DSL3S_H_
+#define _DSL3S_H_
+
+#include <array>
+#include <cstddef>
+#include "bool3S.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// DSL3S: CIRCUITOS DESCRITOS POR TIPOS C++
+/// Permite escrever um circuito combinacional fixo diretamente no codigo, como
+/// uma expressao de tipos, que o compilador transforma em codigo sem desvios,
+/// vetores dinamicos nem funcoes virtuais (e que pode ser avaliada em tempo de
+/// compilacao). As portas tem as mesmas siglas do formato texto:
+///   E<i>            : a entrada i do circuito (id -(i+1)), de 0 a NumInputs-1
+///   NT<X>           : NOT
+///   AN<X...>, NA<X...>, OR<X...>, NO<X...>, XO<X...>, NX<X...> (2 ou mais entradas)
+///   Circuito3S<S...>: o circuito, cujas saidas sao as expressoes S...
+/// Por exemplo, um multiplexador 2x1 (a saida eh a entrada 1 se a entrada 0
+/// for TRUE, ou a entrada 2 se ela for FALSE):
+///   using Sel = E<0>;
+///   using Mux = Circuito3S<OR<AN<Sel, E<1>>, AN<NT<Sel>, E<2>>>>;
+///   constexpr std::array<bool3S, 3> in{bool3S::TRUE, bool3S::FALSE, bool3S::UNDEF};
+///   static_assert(Mux::simular(in)[0] == bool3S::FALSE);
+/// Como cada porta eh uma expressao, os lacos de realimentacao nao podem ser
+/// descritos, e uma porta usada por varias outras eh calculada mais de uma vez
+/// (o compilador costuma eliminar as repeticoes). Para circuitos quaisquer,
+/// inclusive com lacos, usar o gerador de codigo (codigo.h).
+/// Os valores podem ser bool3S ou Palavra3S (64 vetores de uma soh vez).
+/// ###########################################################################
+
+namespace dsl3S
+{
+// A entrada I do circuito
+template <unsigned I>
+struct E
+{
+  template <class V, size_t N>
+  static constexpr V avaliar(const std::array<V, N> &in_circ)
+  {
+    static_assert(I < N, "Entrada inexistente no circuito");
+    return in_circ[I];
+  }
+};
+
+// NOT
+template <class X>
+struct NT
+{
+  template <class V, size_t N>
+  static constexpr V avaliar(const std::array<V, N> &in_circ)
+  {
+    return ~X::template avaliar<V, N>(in_circ);
+  }
+};
+
+// As portas de 2 ou mais entradas, definidas por uma fold expression sobre o operador
+// correspondente da classe bool3S (ou Palavra3S)
+#define DSL3S_PORTA(SIGLA, EXPR)                                              \
+  template <class... X>                                                     \
+  struct SIGLA                                                              \
+  {                                                                         \
+    static_assert(sizeof...(X) >= 2, "A porta deve ter 2 ou mais entradas"); \
+    template <class V, size_t N>                                            \
+    static constexpr V avaliar(const std::array<V, N> &in_circ)             \
+    {                                                                       \
+      return EXPR;                                                          \
+    }                                                                       \
+  };
+
+DSL3S_PORTA(AN, (X::template avaliar<V, N>(in_circ) & ...))
+DSL3S_PORTA(NA, ~(X::template avaliar<V, N>(in_circ) & ...))
+DSL3S_PORTA(OR, (X::template avaliar<V, N>(in_circ) | ...))
+DSL3S_PORTA(NO, ~(X::template avaliar<V, N>(in_circ) | ...))
+DSL3S_PORTA(XO, (X::template avaliar<V, N>(in_circ) ^ ...))
+DSL3S_PORTA(NX, ~(X::template avaliar<V, N>(in_circ) ^ ...))
+
+#undef DSL3S_PORTA
+
+// O circuito, com uma saida para cada expressao S
+template <class... S>
+struct Circuito3S
+{
+  static const unsigned NUM_SAIDAS = sizeof...(S);
+
+  template <class V, size_t N>
+  static constexpr std::array<V, sizeof...(S)> simular(const std::array<V, N> &in_circ)
+  {
+    return std::array<V, sizeof...(S)>{S::template avaliar<V, N>(in_circ)...};
+  }
+};
+} // namespace dsl3S
+
+#endif // _DSL3S_H_
@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <string>
+#include "gerador.h"
+#include "binario.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+using namespace std;
+
+///
+/// CLASSE AUXILIAR GERADOR PSEUDOALEATORIO (soh usada neste arquivo)
+///
+
+namespace
+{
+// xorshift64*: rapido e com o mesmo resultado em qualquer plataforma
+class Aleatorio
+{
+private:
+  uint64_t x;
+
+public:
+  // A semente passa pelo splitmix64, para que sementes proximas nao gerem
+  // sequencias parecidas (e para que a semente 0 seja valida)
+  Aleatorio(uint64_t Semente)
+  {
+    uint64_t z = Semente + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    x = (z ^ (z >> 31)) | 1;
+  }
+
+  uint64_t proximo()
+  {
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    return x * 0x2545f4914f6cdd1dULL;
+  }
+
+  // Um inteiro de 0 a N-1
+  uint64_t ateh(uint64_t N) { return proximo() % N; }
+
+  // Um real em [0, 1), com 53 bits
+  double real() { return (proximo() >> 11) * 0x1.0p-53; }
+};
+} // namespace
+
+// Sorteia o numero de entradas de uma porta (que nao seja NOT)
+static unsigned sortearFanin(const ParametrosGerador &P, Aleatorio &A)
+{
+  if (P.distribuicao == DistribuicaoFanin::UNIFORME)
+    return P.fanin_min + A.ateh(P.fanin_max - P.fanin_min + 1);
+
+  // Geometrica: cada entrada a mais tem probabilidade q, com media fanin_min + q/(1-q)
+  double extra = P.fanin_media - P.fanin_min;
+  double q = (extra > 0.0 ? extra / (extra + 1.0) : 0.0);
+  unsigned n = P.fanin_min;
+  while (n < P.fanin_max && A.real() < q)
+    n++;
+  return n;
+}
+
+const char *erroParametros(const ParametrosGerador &P)
+{
+  uint64_t peso_total = 0;
+  for (unsigned T = 0; T <= unsigned(TipoPorta::NX); T++)
+    peso_total += P.peso_tipo[T];
+  // Soh com portas NOT, fanin_min e fanin_max nao importam
+  bool soh_not = (peso_total == P.peso_tipo[unsigned(TipoPorta::NT)]);
+  if (P.Nin == 0)
+    return "o numero de entradas deve ser maior que 0";
+  if (P.Nout == 0)
+    return "o numero de saidas deve ser maior que 0";
+  if (P.Nportas == 0)
+    return "o numero de portas deve ser maior que 0";
+  if (peso_total == 0)
+    return "todos os tipos de porta tem peso 0";
+  if (peso_total > UINT32_MAX)
+    return "soma dos pesos dos tipos de porta grande demais";
+  if (P.janela == 0)
+    return "a janela deve ser maior que 0";
+  if (!soh_not && P.fanin_min < 2)
+    return "o fan-in minimo deve ser ao menos 2";
+  if (!soh_not && P.fanin_max < P.fanin_min)
+    return "o fan-in maximo deve ser ao menos o minimo";
+  if (P.niveis > P.Nportas)
+    return "o numero de niveis deve ser no maximo o numero de portas";
+  if (!(P.frac_entradas >= 0.0 && P.frac_entradas <= 1.0))
+    return "a fracao de entradas deve estar entre 0 e 1";
+  if (!(P.frac_realimentacao >= 0.0 && P.frac_realimentacao <= 1.0))
+    return "a fracao de realimentacao deve estar entre 0 e 1";
+  return nullptr;
+}
+
+bool gerarCircuito(const ParametrosGerador &P, DescricaoCircuito &D)
+{
+  D.Nin = 0;
+  D.tipos.clear();
+  D.inicio.assign(1, 0);
+  D.id_in.clear();
+  D.id_out.clear();
+
+  if (erroParametros(P) != nullptr)
+    return false;
+  unsigned peso_total = 0;
+  for (unsigned T = 0; T <= unsigned(TipoPorta::NX); T++)
+    peso_total += P.peso_tipo[T];
+
+  Aleatorio A(P.semente);
+  unsigned NP = P.Nportas;
+  D.Nin = P.Nin;
+  D.tipos.resize(NP);
+  D.inicio.resize(NP + 1);
+
+  // Com niveis: as portas do nivel L sao as de indices inicio_nivel(L) a inicio_nivel(L+1)-1
+  auto inicio_nivel = [&](unsigned L) -> unsigned
+  { return unsigned(uint64_t(NP) * L / P.niveis); };
+  unsigned nivel = 0;
+
+  for (unsigned i = 0; i < NP; i++)
+  {
+    // O tipo, de acordo com os pesos
+    unsigned r = A.ateh(peso_total), T = 0;
+    while (r >= P.peso_tipo[T])
+      r -= P.peso_tipo[T++];
+    D.tipos[i] = TipoPorta(T);
+    unsigned n = (TipoPorta(T) == TipoPorta::NT ? 1 : sortearFanin(P, A));
+
+    // As portas (indices a partir de 0) de onde podem vir as entradas: de ini_ant a i-1
+    // (no nivel 0 ou na primeira porta, nenhuma)
+    unsigned ini_ant = (i < P.janela ? 0 : i - P.janela);
+    if (P.niveis > 0)
+    {
+      while (i >= inicio_nivel(nivel + 1))
+        nivel++;
+      if (nivel == 0)
+        ini_ant = i;
+    }
+
+    for (unsigned j = 0; j < n; j++)
+    {
+      int id;
+      if (P.niveis > 0 && nivel > 0 && j == 0)
+      {
+        // A primeira entrada vem do nivel anterior: a profundidade fica exata
+        unsigned a = inicio_nivel(nivel - 1), b = inicio_nivel(nivel);
+        id = int(1 + a + A.ateh(b - a));
+      }
+      else if (P.frac_realimentacao > 0.0 && A.real() < P.frac_realimentacao)
+      {
+        // Uma porta adiante (ou a propria): forma um laco
+        unsigned fim = (NP - i < P.janela ? NP - i : P.janela);
+        id = int(1 + i + A.ateh(fim));
+      }
+      else if (ini_ant == i || A.real() < P.frac_entradas)
+        id = -int(1 + A.ateh(P.Nin));
+      else
+      {
+        // Com niveis, soh portas de niveis anteriores
+        unsigned fim = (P.niveis > 0 ? inicio_nivel(nivel) : i);
+        unsigned ini = min(ini_ant, fim - 1);
+        id = int(1 + ini + A.ateh(fim - ini));
+      }
+      D.id_in.push_back(id);
+    }
+    D.inicio[i + 1] = D.id_in.size();
+  }
+  for (unsigned j = 0; j < P.Nout; j++)
+    D.id_out.push_back(j < NP ? int(NP - j) : -int(1 + (j - NP) % P.Nin));
+  return true;
+}
+
+bool gerarCircuito(unsigned NI, unsigned NO, unsigned NP, uint64_t Semente, DescricaoCircuito &D)
+{
+  ParametrosGerador P;
+  P.Nin = NI;
+  P.Nout = NO;
+  P.Nportas = NP;
+  P.semente = Semente;
+  return gerarCircuito(P, D);
+}
+
+// Grava D no formato texto (o mesmo de Circuito::salvar), montando o texto em um
+// buffer: para circuitos grandes, eh bem mais rapido que passar por Circuito
+static bool salvarTexto(const string &arq, const DescricaoCircuito &D)
+{
+  ofstream arquivo(arq);
+  if (!arquivo.is_open())
+    return false;
+  string buffer;
+  char num[16];
+  auto inteiro = [&](long long x)
+  {
+    buffer.append(num, to_chars(num, num + sizeof(num), x).ptr);
+  };
+
+  unsigned NP = D.tipos.size();
+  buffer = "CIRCUITO " + to_string(D.Nin) + ' ' + to_string(D.id_out.size()) + ' ' +
+           to_string(NP) + "\nPORTAS\n";
+  for (unsigned i = 0; i < NP; i++)
+  {
+    inteiro(i + 1);
+    buffer += ") " + toSigla(D.tipos[i]) + ' ';
+    inteiro(D.inicio[i + 1] - D.inicio[i]);
+    buffer += ':';
+    for (uint32_t j = D.inicio[i]; j < D.inicio[i + 1]; j++)
+    {
+      buffer += ' ';
+      inteiro(D.id_in[j]);
+    }
+    buffer += '\n';
+    if (buffer.size() >= 65536)
+    {
+      arquivo.write(buffer.data(), buffer.size());
+      buffer.clear();
+    }
+  }
+  buffer += "SAIDAS\n";
+  for (unsigned j = 0; j < D.id_out.size(); j++)
+  {
+    inteiro(j + 1);
+    buffer += ") ";
+    inteiro(D.id_out[j]);
+    buffer += '\n';
+  }
+  arquivo.write(buffer.data(), buffer.size());
+  arquivo.close();
+  return !arquivo.fail();
+}
+
+bool salvarCircuitoGerado(const ParametrosGerador &P, const std::string &arq, bool Binario)
+{
+  DescricaoCircuito D;
+  if (!gerarCircuito(P, D))
+    return false;
+  return (Binario ? salvarNetlistBinaria(arq, D) : salvarTexto(arq, D));
+}
@@ -0,0 +1,81 @@
+#ifndef _GERADOR_H_
+#define _GERADOR_H_
+
+#include <cstdint>
+#include <string>
+#include "netlist.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// GERADOR DE CIRCUITOS SINTETICOS
+/// Gera circuitos validos de qualquer tamanho, para medicoes de desempenho e
+/// testes: o circuito depende apenas dos parametros e da semente (o gerador
+/// pseudoaleatorio eh implementado aqui, sem as distribuicoes da biblioteca
+/// padrao, cujos resultados mudam de uma implementacao para outra).
+/// ###########################################################################
+
+// Distribuicao do numero de entradas das portas (exceto NOT, que sempre tem 1)
+enum class DistribuicaoFanin
+{
+  UNIFORME,  // igualmente provavel de fanin_min a fanin_max
+  GEOMETRICA // fanin_min + numero de sucessos seguidos, com media fanin_media
+             // (muitas portas pequenas e poucas grandes), limitado a fanin_max
+};
+
+// Os parametros de um circuito gerado
+struct ParametrosGerador
+{
+  unsigned Nin = 32;
+  unsigned Nout = 16;
+  unsigned Nportas = 1000;
+
+  // Peso relativo de cada tipo de porta, na ordem de TipoPorta (NT, AN, NA, OR, NO, XO, NX)
+  unsigned peso_tipo[7] = {1, 1, 1, 1, 1, 1, 1};
+
+  DistribuicaoFanin distribuicao = DistribuicaoFanin::UNIFORME;
+  unsigned fanin_min = 2;
+  unsigned fanin_max = 4;
+  double fanin_media = 2.5; // soh na distribuicao geometrica
+
+  // Fracao das entradas de portas que vem de entradas do circuito (as demais vem de portas)
+  double frac_entradas = 0.25;
+
+  // As entradas de cada porta vem de uma das "janela" portas anteriores (localidade)
+  unsigned janela = 1024;
+
+  // Numero de niveis (profundidade) da parte aciclica; 0: livre
+  // Com niveis > 0, as portas sao divididas em faixas consecutivas, uma por nivel:
+  // a primeira entrada de cada porta vem do nivel anterior, e as demais de qualquer
+  // nivel anterior (as do nivel 0 soh usam entradas do circuito)
+  unsigned niveis = 0;
+
+  // Fracao das entradas de portas que vem de uma porta posterior (ateh "janela" portas
+  // adiante), formando lacos de realimentacao; 0: circuito aciclico
+  double frac_realimentacao = 0.0;
+
+  uint64_t semente = 1;
+};
+
+// Confere os parametros P: retorna nullptr se forem validos ou a descricao do
+// primeiro parametro invalido (algum numero zero, fan-in incoerente, todos os pesos
+// nulos, mais niveis que portas, fracao fora de [0, 1])
+const char *erroParametros(const ParametrosGerador &P);
+
+// Preenche D (ver DescricaoCircuito) com um circuito aleatorio com os parametros P
+// As saidas do circuito vem das ultimas portas
+// Retorna false (e D fica vazia) se os parametros forem invalidos (ver erroParametros)
+bool gerarCircuito(const ParametrosGerador &P, DescricaoCircuito &D);
+
+// Idem, com NI entradas, NO saidas, NP portas, a semente Semente e os demais
+// parametros com os valores padrao: circuito aciclico, com portas de todos os tipos,
+// NOT com 1 entrada e as demais com 2 a 4
+bool gerarCircuito(unsigned NI, unsigned NO, unsigned NP, uint64_t Semente, DescricaoCircuito &D);
+
+// Gera o circuito com os parametros P e o grava no arquivo arq, no formato binario se
+// Binario for true (ver binario.h) ou no formato texto (o de Circuito::salvar)
+// Retorna true se deu tudo OK; false se deu erro
+bool salvarCircuitoGerado(const ParametrosGerador &P, const std::string &arq, bool Binario);
+
+#endif // _GERADOR_H_
@@ -0,0 +1,160 @@
+#include <iostream>
+#include <mutex>
+#include <vector>
+#include "instrumentacao.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+using namespace std;
+
+#ifdef CIRCUITO_INSTRUMENTACAO
+
+// Soma os contadores C em Total (todos os campos sao uint64_t)
+static void somarContadores(ContadoresInstrumentacao &Total, const ContadoresInstrumentacao &C)
+{
+  const uint64_t *c = reinterpret_cast<const uint64_t *>(&C);
+  uint64_t *t = reinterpret_cast<uint64_t *>(&Total);
+  for (size_t i = 0; i < sizeof(C) / sizeof(uint64_t); i++)
+    t[i] += c[i];
+}
+
+namespace
+{
+// Os contadores de todas as threads
+struct RegistroContadores
+{
+  mutex trava;
+  // Os contadores das threads em execucao
+  vector<ContadoresInstrumentacao *> ativos;
+  // A soma dos contadores das threads que jah terminaram
+  ContadoresInstrumentacao encerrados{};
+};
+
+RegistroContadores &registro()
+{
+  static RegistroContadores R;
+  return R;
+}
+
+// Tira os contadores da thread do registro quando ela termina (guardando a soma)
+struct SaidaThread
+{
+  ~SaidaThread()
+  {
+    RegistroContadores &R = registro();
+    lock_guard<mutex> trava(R.trava);
+    somarContadores(R.encerrados, contadores_thread);
+    for (size_t i = 0; i < R.ativos.size(); i++)
+      if (R.ativos[i] == &contadores_thread)
+      {
+        R.ativos[i] = R.ativos.back();
+        R.ativos.pop_back();
+        break;
+      }
+  }
+};
+} // namespace
+
+void registrarContadoresThread()
+{
+  RegistroContadores &R = registro();
+  {
+    lock_guard<mutex> trava(R.trava);
+    R.ativos.push_back(&contadores_thread);
+  }
+  thread_local SaidaThread saida;
+  contadores_registrados = true;
+}
+
+bool instrumentacaoAtiva() { return true; }
+
+void zerarInstrumentacao()
+{
+  RegistroContadores &R = registro();
+  lock_guard<mutex> trava(R.trava);
+  R.encerrados = ContadoresInstrumentacao{};
+  for (ContadoresInstrumentacao *C : R.ativos)
+    *C = ContadoresInstrumentacao{};
+}
+
+ContadoresInstrumentacao lerInstrumentacao()
+{
+  RegistroContadores &R = registro();
+  lock_guard<mutex> trava(R.trava);
+  ContadoresInstrumentacao Total = R.encerrados;
+  for (const ContadoresInstrumentacao *C : R.ativos)
+    somarContadores(Total, *C);
+  return Total;
+}
+
+#else
+
+bool instrumentacaoAtiva() { return false; }
+
+void zerarInstrumentacao() {}
+
+ContadoresInstrumentacao lerInstrumentacao() { return ContadoresInstrumentacao{}; }
+
+#endif // CIRCUITO_INSTRUMENTACAO
+
+///
+/// RELATORIO
+///
+
+void relatorioInstrumentacao(std::ostream &O, FormatoRelatorio F)
+{
+  static const char *nome_fase[NUM_FASES_INSTRUMENTADAS] = {"leitura", "compilacao", "simulacao",
+                                                            "saida"};
+  ContadoresInstrumentacao C = lerInstrumentacao();
+  uint64_t avaliacoes = 0, valores = 0, indefinidos = 0;
+  for (int T = 0; T <= int(TipoPorta::NX); T++)
+  {
+    avaliacoes += C.avaliacoes[T];
+    valores += C.valores[T];
+    indefinidos += C.indefinidos[T];
+  }
+
+  if (F == FormatoRelatorio::CSV)
+  {
+    O << "categoria,nome,medida,valor\n";
+    O << "geral,instrumentacao,ativa," << instrumentacaoAtiva() << "\n";
+    O << "geral,simulacao,simulacoes," << C.simulacoes << "\n";
+    O << "geral,simulacao,reavaliacoes_lacos," << C.reavaliacoes << "\n";
+    for (int T = 0; T <= int(TipoPorta::NX); T++)
+    {
+      string tipo = toSigla(TipoPorta(T));
+      O << "porta," << tipo << ",avaliacoes," << C.avaliacoes[T] << "\n";
+      O << "porta," << tipo << ",valores," << C.valores[T] << "\n";
+      O << "porta," << tipo << ",indefinidos," << C.indefinidos[T] << "\n";
+    }
+    O << "porta,total,avaliacoes," << avaliacoes << "\n";
+    O << "porta,total,valores," << valores << "\n";
+    O << "porta,total,indefinidos," << indefinidos << "\n";
+    for (unsigned f = 0; f < NUM_FASES_INSTRUMENTADAS; f++)
+    {
+      O << "fase," << nome_fase[f] << ",chamadas," << C.chamadas[f] << "\n";
+      O << "fase," << nome_fase[f] << ",segundos," << C.nanossegundos[f] * 1e-9 << "\n";
+    }
+    return;
+  }
+
+  O << "{\n";
+  O << "  \"instrumentacao\": " << (instrumentacaoAtiva() ? "true" : "false") << ",\n";
+  O << "  \"simulacoes\": " << C.simulacoes << ",\n";
+  O << "  \"reavaliacoes_lacos\": " << C.reavaliacoes << ",\n";
+  O << "  \"portas\": {\n";
+  for (int T = 0; T <= int(TipoPorta::NX); T++)
+    O << "    \"" << toSigla(TipoPorta(T)) << "\": {\"avaliacoes\": " << C.avaliacoes[T]
+      << ", \"valores\": " << C.valores[T] << ", \"indefinidos\": " << C.indefinidos[T] << "},\n";
+  O << "    \"total\": {\"avaliacoes\": " << avaliacoes << ", \"valores\": " << valores
+    << ", \"indefinidos\": " << indefinidos << "}\n";
+  O << "  },\n";
+  O << "  \"fases\": {\n";
+  for (unsigned f = 0; f < NUM_FASES_INSTRUMENTADAS; f++)
+    O << "    \"" << nome_fase[f] << "\": {\"chamadas\": " << C.chamadas[f]
+      << ", \"segundos\": " << C.nanossegundos[f] * 1e-9 << "}"
+      << (f + 1 < NUM_FASES_INSTRUMENTADAS ? ",\n" : "\n");
+  O << "  }\n";
+  O << "}\n";
+}
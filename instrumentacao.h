@@ -0,0 +1,151 @@
+#ifndef _INSTRUMENTACAO_H_
+#define _INSTRUMENTACAO_H_
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include "bool3S.h"
+#include "palavra3S.h"
+#include "avaliador.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// INSTRUMENTACAO DA SIMULACAO
+/// Contadores para saber onde vai o tempo da simulacao: portas avaliadas (por
+/// tipo), valores que ficaram indefinidos, reavaliacoes de portas nos lacos
+/// de realimentacao (ponto fixo) e o tempo de cada fase (leitura, compilacao, simulacao e
+/// saida dos resultados).
+/// Soh eh compilada com CIRCUITO_INSTRUMENTACAO definido (no CMake: opcao
+/// CIRCUITO_INSTRUMENTACAO=ON); sem ele, as macros INSTR_* nao geram codigo e
+/// o relatorio sai zerado.
+/// Cada thread conta nos seus proprios contadores (sem travas nem operacoes
+/// atomicas no caminho critico), que sao somados no relatorio. Por isso o
+/// relatorio soh deve ser lido quando nenhuma thread estiver simulando.
+/// ###########################################################################
+
+// As fases medidas
+enum class FaseInstrumentada : uint8_t
+{
+  LEITURA,    // leitura do circuito (Circuito::ler, lerBinario) e dos vetores de entrada
+  COMPILACAO, // montagem da netlist (e compilacao do codigo nativo)
+  SIMULACAO,  // Netlist::simular e resimular (e o simulador nativo)
+  SAIDA       // formatacao e escrita dos resultados (circuitos, tabelas, lotes)
+};
+const unsigned NUM_FASES_INSTRUMENTADAS = 4;
+
+// Os contadores (de uma thread ou a soma de todas)
+// Na simulacao de 64 ou 512 vetores de uma vez, cada avaliacao de porta calcula
+// 64 ou 512 valores
+struct ContadoresInstrumentacao
+{
+  uint64_t simulacoes;    // chamadas de Netlist::simular e resimular
+  uint64_t reavaliacoes;  // reavaliacoes de portas nos lacos (alem da primeira avaliacao)
+  uint64_t avaliacoes[7]; // avaliacoes de portas, por tipo (na ordem de TipoPorta)
+  uint64_t valores[7];    // valores calculados nessas avaliacoes
+  uint64_t indefinidos[7]; // valores calculados que ficaram UNDEF
+  uint64_t chamadas[NUM_FASES_INSTRUMENTADAS];     // medicoes de cada fase
+  uint64_t nanossegundos[NUM_FASES_INSTRUMENTADAS]; // tempo total de cada fase
+};
+
+// Retorna true se a instrumentacao foi compilada (CIRCUITO_INSTRUMENTACAO)
+bool instrumentacaoAtiva();
+
+// Zera os contadores de todas as threads
+void zerarInstrumentacao();
+
+// Retorna a soma dos contadores de todas as threads
+ContadoresInstrumentacao lerInstrumentacao();
+
+// Imprime o relatorio da instrumentacao em O, no formato JSON ou CSV
+// (colunas categoria,nome,medida,valor)
+enum class FormatoRelatorio
+{
+  JSON,
+  CSV
+};
+void relatorioInstrumentacao(std::ostream &O, FormatoRelatorio F);
+
+/// ***********************
+/// Uso interno (pelas macros INSTR_*)
+/// ***********************
+
+#ifdef CIRCUITO_INSTRUMENTACAO
+
+// Os contadores da thread atual (inicialmente zerados: sem custo de inicializacao)
+inline thread_local ContadoresInstrumentacao contadores_thread{};
+inline thread_local bool contadores_registrados = false;
+
+// Inclui os contadores da thread atual na soma do relatorio
+void registrarContadoresThread();
+
+inline ContadoresInstrumentacao &contadoresThread()
+{
+  if (!contadores_registrados)
+    registrarContadoresThread();
+  return contadores_thread;
+}
+
+// Numero de valores indefinidos em S
+inline unsigned contarIndefinidos(bool3S S) { return S == bool3S::UNDEF; }
+inline unsigned contarIndefinidos(const Palavra3S &S) { return __builtin_popcountll(~(S.t | S.f)); }
+inline unsigned contarIndefinidos(const Bloco3S &S)
+{
+  unsigned N = 0;
+  for (unsigned w = 0; w < PALAVRAS_BLOCO3S; w++)
+    N += __builtin_popcountll(~(S.t[w] | S.f[w]));
+  return N;
+}
+
+// Numero de valores em S
+inline unsigned contarValores(bool3S) { return 1; }
+inline unsigned contarValores(const Palavra3S &) { return BITS_PALAVRA3S; }
+inline unsigned contarValores(const Bloco3S &) { return BITS_BLOCO3S; }
+
+// Conta uma avaliacao de porta do tipo T, cujo resultado foi S
+template <class V>
+inline void contarAvaliacao(TipoPorta T, const V &S)
+{
+  ContadoresInstrumentacao &C = contadoresThread();
+  C.avaliacoes[int(T)]++;
+  C.valores[int(T)] += contarValores(S);
+  C.indefinidos[int(T)] += contarIndefinidos(S);
+}
+
+// Mede o tempo de uma fase: do construtor ao destrutor
+class MedidorFase
+{
+private:
+  FaseInstrumentada fase;
+  std::chrono::steady_clock::time_point inicio;
+
+public:
+  explicit MedidorFase(FaseInstrumentada F) : fase(F), inicio(std::chrono::steady_clock::now()) {}
+  ~MedidorFase()
+  {
+    ContadoresInstrumentacao &C = contadoresThread();
+    C.chamadas[int(fase)]++;
+    C.nanossegundos[int(fase)] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::steady_clock::now() - inicio)
+                                      .count();
+  }
+  MedidorFase(const MedidorFase &) = delete;
+  void operator=(const MedidorFase &) = delete;
+};
+
+#define INSTR_SIMULACAO() (contadoresThread().simulacoes++)
+#define INSTR_REAVALIACOES(N) (contadoresThread().reavaliacoes += (N))
+#define INSTR_AVALIACAO(T, S) contarAvaliacao(T, S)
+#define INSTR_FASE(F) MedidorFase instr_medidor_fase_(FaseInstrumentada::F)
+
+#else
+
+#define INSTR_SIMULACAO() ((void)0)
+#define INSTR_REAVALIACOES(N) ((void)0)
+#define INSTR_AVALIACAO(T, S) ((void)0)
+#define INSTR_FASE(F) ((void)0)
+
+#endif // CIRCUITO_INSTRUMENTACAO
+
+#endif // _INSTRUMENTACAO_H_
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "leitor.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+using namespace std;
+
+///
+/// CLASSE AUXILIAR LEITOR (soh usada neste arquivo)
+///
+
+// Percorre o buffer, mantendo a linha e a coluna da posicao atual para as mensagens de erro
+namespace
+{
+class Leitor
+{
+private:
+  const char *p;           // posicao atual
+  const char *fim;         // fim do buffer
+  const char *ini_linha;   // inicio da linha atual
+  unsigned linha;          // linha atual (a partir de 1)
+
+public:
+  Leitor(const char *Dados, size_t Tamanho)
+      : p(Dados), fim(Dados + Tamanho), ini_linha(Dados), linha(1) {}
+
+  // Pula os espacos em branco (inclusive quebras de linha)
+  void pularBrancos()
+  {
+    while (p < fim)
+    {
+      char c = *p;
+      if (c == '\n')
+      {
+        linha++;
+        ini_linha = ++p;
+      }
+      else if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v')
+        p++;
+      else
+        break;
+    }
+  }
+
+  bool terminou() const { return p >= fim; }
+
+  // Imprime a mensagem de erro com a posicao atual e retorna false
+  bool erro(const char *Msg) const
+  {
+    cerr << "Erro (linha " << linha << ", coluna " << (p - ini_linha) + 1 << "): " << Msg << endl;
+    return false;
+  }
+
+  // Leh a proxima palavra (sequencia de caracteres nao brancos)
+  // Retorna false se chegou ao fim do buffer
+  bool palavra(const char *&Ini, size_t &N)
+  {
+    pularBrancos();
+    Ini = p;
+    while (p < fim && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n' &&
+           *p != '\f' && *p != '\v')
+      p++;
+    N = p - Ini;
+    return N > 0;
+  }
+
+  // Leh a palavra-chave Chave (ou Chave seguida de ':', se Dois_pontos for true)
+  bool chave(const char *Chave, bool Dois_pontos = false)
+  {
+    pularBrancos();
+    const char *ini = p;
+    const char *pal;
+    size_t n, nc = strlen(Chave);
+    palavra(pal, n);
+    if (Dois_pontos && n == nc + 1 && pal[nc] == ':')
+      n--;
+    if (n != nc || memcmp(pal, Chave, n) != 0)
+    {
+      p = ini;
+      string msg = string("Palavra chave '") + Chave + "' esperada";
+      return erro(msg.c_str());
+    }
+    return true;
+  }
+
+  // Leh um inteiro (com sinal opcional)
+  // Em caso de erro, mantem a posicao no inicio do inteiro
+  bool inteiro(long long &X)
+  {
+    pularBrancos();
+    const char *ini = p;
+    if (p < fim && *p == '+')
+      p++;
+    from_chars_result r = from_chars(p, fim, X);
+    if (r.ec != errc() || (r.ptr < fim && *r.ptr != ':' && *r.ptr != ')' &&
+                           *r.ptr != ' ' && *r.ptr != '\t' && *r.ptr != '\r' &&
+                           *r.ptr != '\n' && *r.ptr != '\f' && *r.ptr != '\v'))
+    {
+      p = ini;
+      return erro("Numero inteiro esperado");
+    }
+    p = r.ptr;
+    return true;
+  }
+
+  // Leh o caractere C (podendo haver espacos antes dele)
+  bool caractere(char C)
+  {
+    pularBrancos();
+    if (p >= fim || *p != C)
+    {
+      char msg[] = "Caractere ' ' esperado";
+      msg[11] = C;
+      return erro(msg);
+    }
+    p++;
+    return true;
+  }
+
+  // Leh a numeracao "N)" de uma linha, que deve ser igual a Esperado
+  bool numeracao(long long Esperado, const char *Msg)
+  {
+    pularBrancos();
+    const char *ini = p;
+    long long n;
+    if (!inteiro(n))
+      return false;
+    if (n != Esperado)
+    {
+      p = ini;
+      return erro(Msg);
+    }
+    return caractere(')');
+  }
+
+  // Posicao atual, para voltar a ela ao informar um erro
+  const char *posicao() const { return p; }
+  void voltar(const char *Pos) { p = Pos; }
+};
+} // namespace
+
+/// ***********************
+/// Leitura do circuito
+/// ***********************
+
+bool lerTextoCircuito(const char *Dados, size_t Tamanho, DescricaoCircuito &D)
+{
+  Leitor L(Dados, Tamanho);
+  long long NI, NO, NP, n;
+  const char *pos;
+
+  D = DescricaoCircuito();
+
+  // Cabecalho
+  if (!L.chave("CIRCUITO"))
+    return false;
+  L.pularBrancos();
+  pos = L.posicao();
+  if (!L.inteiro(NI) || !L.inteiro(NO) || !L.inteiro(NP))
+    return false;
+  if (NI <= 0 || NO <= 0 || NP <= 0 || NI > INT32_MAX || NO > INT32_MAX || NP > INT32_MAX)
+  {
+    L.voltar(pos);
+    return L.erro("Cabecalho fora do padrao esperado");
+  }
+  // Cada porta e cada saida ocupa ao menos um caractere do arquivo: sem isso, um
+  // cabecalho invalido faria alocar memoria demais (os vetores sao dimensionados aqui)
+  if (NP + NO > (long long)min<size_t>(Tamanho, INT64_MAX / 2))
+  {
+    L.voltar(pos);
+    return L.erro("Numero de portas ou de saidas maior que o tamanho do arquivo");
+  }
+  auto validIdOrig = [&](long long Id)
+  { return (Id <= -1 && Id >= -NI) || (Id >= 1 && Id <= NP); };
+
+  D.Nin = NI;
+  D.tipos.resize(NP);
+  D.inicio.resize(NP + 1);
+  D.inicio[0] = 0;
+  D.id_in.reserve(2 * NP);
+  D.id_out.resize(NO);
+
+  // Portas
+  if (!L.chave("PORTAS"))
+    return false;
+  for (long long i = 0; i < NP; i++)
+  {
+    const char *sigla;
+    size_t ns;
+    if (!L.numeracao(i + 1, "Portas faltando ou nao estao ordenadas"))
+      return false;
+    L.pularBrancos();
+    pos = L.posicao();
+    if (!L.palavra(sigla, ns) || !toTipoPorta(string(sigla, ns), D.tipos[i]))
+    {
+      L.voltar(pos);
+      return L.erro("Tipo de porta invalido");
+    }
+    L.pularBrancos();
+    pos = L.posicao();
+    if (!L.inteiro(n))
+      return false;
+    if (D.tipos[i] == TipoPorta::NT ? n != 1 : (n < 2 || n > INT32_MAX))
+    {
+      L.voltar(pos);
+      return L.erro("Numero de entradas invalido para a porta");
+    }
+    if (!L.caractere(':'))
+      return false;
+    for (long long j = 0; j < n; j++)
+    {
+      long long id;
+      L.pularBrancos();
+      pos = L.posicao();
+      if (!L.inteiro(id))
+        return false;
+      if (!validIdOrig(id))
+      {
+        L.voltar(pos);
+        return L.erro("Id de origem invalida");
+      }
+      D.id_in.push_back(id);
+    }
+    D.inicio[i + 1] = D.id_in.size();
+  }
+
+  // Saidas
+  if (!L.chave("SAIDAS", true))
+    return false;
+  for (long long j = 0; j < NO; j++)
+  {
+    long long id;
+    if (!L.numeracao(j + 1, "Saidas fora de ordem, ou faltando"))
+      return false;
+    L.pularBrancos();
+    pos = L.posicao();
+    if (!L.inteiro(id))
+      return false;
+    if (!validIdOrig(id))
+    {
+      L.voltar(pos);
+      return L.erro("Id de origem invalida");
+    }
+    D.id_out[j] = id;
+  }
+  return true;
+}
@@ -0,0 +1,33 @@
+#ifndef _LEITOR_H_
+#define _LEITOR_H_
+
+#include <cstddef>
+#include "netlist.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// LEITURA DO FORMATO TEXTO DE CIRCUITO
+/// Interpreta o conteudo inteiro de um arquivo texto de circuito (o mesmo que eh
+/// gerado por Circuito::salvar), que ja deve estar na memoria (p.ex. mapeado por
+/// ArquivoMapeado). Nao usa streams: percorre os bytes uma unica vez e converte
+/// os inteiros com std::from_chars, sem depender do locale. O formato eh:
+///   CIRCUITO NumInputs NumOutputs NumPorts
+///   PORTAS
+///   1) XX N: id id ...      (uma linha para cada porta, em ordem)
+///   SAIDAS                  (aceita tambem "SAIDAS:")
+///   1) id                   (uma linha para cada saida, em ordem)
+/// Os espacos em branco entre os itens podem ser quaisquer (inclusive quebras de
+/// linha); o ':' pode vir colado ou nao ao numero de entradas.
+/// ###########################################################################
+
+// Interpreta os Tamanho bytes de Dados e preenche D com a descricao do circuito
+// Confere o cabecalho, a numeracao das portas e das saidas, os tipos das portas,
+// o numero de entradas de cada porta e todas as ids de origem
+// Em caso de erro, imprime em cerr a mensagem, com a linha e a coluna do arquivo
+// em que ele ocorreu
+// Retorna true se deu tudo OK; false se deu erro
+bool lerTextoCircuito(const char *Dados, size_t Tamanho, DescricaoCircuito &D);
+
+#endif // _LEITOR_H_
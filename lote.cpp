@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "lote.h"
+#include "netlist.h"
+#include "palavra3S.h"
+#include "instrumentacao.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+using namespace std;
+
+///
+/// CLASSE AUXILIAR LEITOR DE VETORES (soh usada neste arquivo)
+///
+
+namespace
+{
+// Leh os vetores de entrada de um stream, em qualquer dos formatos, por um buffer
+// proprio (sem ler valor a valor pelo stream)
+class LeitorVetores
+{
+private:
+  istream &In;
+  FormatoLote formato;
+  unsigned NI;
+  vector<char> buf;
+  size_t ini, fim; // a parte de buf ainda nao usada
+  bool acabou;     // true se o stream jah terminou
+  uint64_t linha;  // linha (formato texto) ou vetor (formato binario) atual, a partir de 1
+
+  // Acrescenta em buf mais dados do stream, depois de descartar a parte jah usada
+  void completar()
+  {
+    if (ini > 0)
+    {
+      memmove(buf.data(), buf.data() + ini, fim - ini);
+      fim -= ini;
+      ini = 0;
+    }
+    // Uma linha maior que o buffer inteiro
+    if (fim == buf.size())
+      buf.resize(2 * buf.size());
+    In.read(buf.data() + fim, buf.size() - fim);
+    fim += In.gcount();
+    if (In.gcount() == 0)
+      acabou = true;
+  }
+
+  // Leh o proximo vetor no formato texto para V (NI valores)
+  // Retorna 1 se leu, 0 se a entrada terminou, -1 se deu erro
+  int lerTexto(uint8_t *V)
+  {
+    while (true)
+    {
+      const char *p = buf.data() + ini;
+      const char *nl = static_cast<const char *>(memchr(p, '\n', fim - ini));
+      if (nl == nullptr && !acabou)
+      {
+        completar();
+        continue;
+      }
+      if (nl == nullptr && ini == fim)
+        return 0;
+
+      const char *fim_linha = (nl != nullptr ? nl : buf.data() + fim);
+      unsigned n = 0;
+      for (const char *q = p; q < fim_linha; q++)
+      {
+        char c = *q;
+        if (c == ' ' || c == '\t' || c == '\r')
+          continue;
+        // Aceita tambem f e t minusculos, como toBool3S
+        if (c == 'f' || c == 't')
+          c -= 'a' - 'A';
+        if (c != 'F' && c != 'T' && c != '?')
+        {
+          cerr << "Erro (linha " << linha << ", coluna " << (q - p) + 1
+               << "): Valor invalido (deve ser F, T ou ?)\n";
+          return -1;
+        }
+        if (n < NI)
+          V[n] = uint8_t(c == 'T' ? bool3S::TRUE : c == 'F' ? bool3S::FALSE : bool3S::UNDEF);
+        n++;
+      }
+      ini = (nl != nullptr ? nl + 1 - buf.data() : fim);
+      linha++;
+      if (n == 0)
+        continue;
+      if (n != NI)
+      {
+        cerr << "Erro (linha " << linha - 1 << "): Vetor com " << n << " valores (o circuito tem "
+             << NI << " entradas)\n";
+        return -1;
+      }
+      return 1;
+    }
+  }
+
+  // Leh o proximo vetor no formato binario para V (NI valores)
+  // Retorna 1 se leu, 0 se a entrada terminou, -1 se deu erro
+  int lerBinario(uint8_t *V)
+  {
+    size_t BI = (NI + 3) / 4;
+    while (fim - ini < BI && !acabou)
+      completar();
+    if (ini == fim)
+      return 0;
+    if (fim - ini < BI)
+    {
+      cerr << "Erro: Vetor binario incompleto no final da entrada\n";
+      return -1;
+    }
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(buf.data() + ini);
+    for (unsigned i = 0; i < NI; i++)
+    {
+      V[i] = (p[i / 4] >> (2 * (i % 4))) & 3;
+      // O codigo 3 nao corresponde a nenhum valor de bool3S
+      if (V[i] == 3)
+      {
+        cerr << "Erro (vetor " << linha << ", entrada " << i + 1 << "): Valor binario invalido (3)\n";
+        return -1;
+      }
+    }
+    ini += BI;
+    linha++;
+    return 1;
+  }
+
+public:
+  LeitorVetores(istream &In, FormatoLote Formato, unsigned NI)
+      : In(In), formato(Formato), NI(NI), buf(1 << 16), ini(0), fim(0), acabou(false), linha(1) {}
+
+  // Leh ateh Max vetores para Valores (o vetor v ocupa Valores[v*NI] .. Valores[v*NI+NI-1])
+  // N recebe o numero de vetores lidos (N < Max somente no fim da entrada)
+  // Retorna false se deu erro
+  bool ler(unsigned Max, uint8_t *Valores, unsigned &N)
+  {
+    for (N = 0; N < Max; N++)
+    {
+      int r = (formato == FormatoLote::TEXTO ? lerTexto(Valores + size_t(N) * NI)
+                                             : lerBinario(Valores + size_t(N) * NI));
+      if (r < 0)
+        return false;
+      if (r == 0)
+        break;
+    }
+    return true;
+  }
+};
+} // namespace
+
+/// ***********************
+/// Simulacao em lote
+/// ***********************
+
+// Simula os vetores de V0 a V1-1 do lote (valores de entrada em Valores, como lidos
+// por LeitorVetores), de 512 em 512, e acrescenta as saidas em Buffer
+static void simularTrechoLote(const Netlist &N, const uint8_t *Valores, unsigned V0, unsigned V1,
+                              FormatoLote FormatoOut, vector<Bloco3S> &in_circ,
+                              vector<Bloco3S> &valores, string &Buffer)
+{
+  unsigned NI = N.getNumInputs();
+  unsigned NO = N.getNumOutputs();
+  unsigned BO = (NO + 3) / 4;
+
+  for (unsigned v0 = V0; v0 < V1; v0 += BITS_BLOCO3S)
+  {
+    unsigned nb = (V1 - v0 < BITS_BLOCO3S ? V1 - v0 : BITS_BLOCO3S);
+
+    // O vetor v0+b vai para o bit b dos blocos de entrada
+    for (unsigned i = 0; i < NI; i++)
+      in_circ[i] = blocoUNDEF();
+    for (unsigned b = 0; b < nb; b++)
+    {
+      const uint8_t *V = Valores + size_t(v0 + b) * NI;
+      unsigned w = b / BITS_PALAVRA3S, k = b % BITS_PALAVRA3S;
+      for (unsigned i = 0; i < NI; i++)
+      {
+        in_circ[i].t[w] |= uint64_t(V[i] == uint8_t(bool3S::TRUE)) << k;
+        in_circ[i].f[w] |= uint64_t(V[i] == uint8_t(bool3S::FALSE)) << k;
+      }
+    }
+
+    N.simular(in_circ.data(), valores.data());
+
+    INSTR_FASE(SAIDA);
+    if (FormatoOut == FormatoLote::TEXTO)
+    {
+      for (unsigned b = 0; b < nb; b++)
+        for (unsigned j = 0; j < NO; j++)
+        {
+          Buffer += toChar(getBool3S(valores[N.getSaida(j)], b));
+          Buffer += (j < NO - 1 ? ' ' : '\n');
+        }
+    }
+    else
+    {
+      size_t pos = Buffer.size();
+      Buffer.resize(pos + size_t(nb) * BO, '\0');
+      char *p = &Buffer[pos];
+      for (unsigned j = 0; j < NO; j++)
+      {
+        const Bloco3S &S = valores[N.getSaida(j)];
+        unsigned desl = 2 * (j % 4);
+        char *q = p + j / 4;
+        for (unsigned b = 0; b < nb; b++, q += BO)
+        {
+          unsigned w = b / BITS_PALAVRA3S, k = b % BITS_PALAVRA3S;
+          unsigned x = (((S.t[w] >> k) & 1) << 1) | ((S.f[w] >> k) & 1);
+          *q |= char(x << desl);
+        }
+      }
+    }
+  }
+}
+
+bool simularLote(const Circuito &C, std::istream &In, std::ostream &Out,
+                 FormatoLote FormatoIn, FormatoLote FormatoOut, uint64_t &Nvetores,
+                 unsigned VetoresLote, unsigned NThreads)
+{
+  Nvetores = 0;
+  if (!C.valid())
+    return false;
+
+  const Netlist &N = C.getNetlist();
+  unsigned NI = N.getNumInputs();
+
+  // Cada thread fica com um multiplo de 512 vetores do lote
+  if (VetoresLote < BITS_BLOCO3S)
+    VetoresLote = BITS_BLOCO3S;
+  VetoresLote -= VetoresLote % BITS_BLOCO3S;
+  if (NThreads == 0)
+    NThreads = thread::hardware_concurrency();
+  if (NThreads == 0)
+    NThreads = 1;
+  if (NThreads > VetoresLote / BITS_BLOCO3S)
+    NThreads = VetoresLote / BITS_BLOCO3S;
+
+  LeitorVetores leitor(In, FormatoIn, NI);
+  vector<uint8_t> entradas(size_t(VetoresLote) * NI);
+  vector<vector<Bloco3S>> in_circ(NThreads, vector<Bloco3S>(NI));
+  vector<vector<Bloco3S>> valores(NThreads, vector<Bloco3S>(N.getNumSinais()));
+  vector<string> buffer(NThreads);
+  bool ok;
+
+  do
+  {
+    unsigned Nlidos;
+    {
+      INSTR_FASE(LEITURA);
+      ok = leitor.ler(VetoresLote, entradas.data(), Nlidos);
+    }
+    if (Nlidos == 0)
+      break;
+
+    // Os blocos do lote sao divididos em partes contiguas, uma por thread
+    unsigned Nblocos = (Nlidos + BITS_BLOCO3S - 1) / BITS_BLOCO3S;
+    unsigned Nt = (NThreads < Nblocos ? NThreads : Nblocos);
+    auto trecho = [&](unsigned t)
+    {
+      unsigned V0 = min(Nlidos, (Nblocos * t / Nt) * BITS_BLOCO3S);
+      unsigned V1 = min(Nlidos, (Nblocos * (t + 1) / Nt) * BITS_BLOCO3S);
+      buffer[t].clear();
+      simularTrechoLote(N, entradas.data(), V0, V1, FormatoOut, in_circ[t], valores[t], buffer[t]);
+    };
+    if (Nt <= 1)
+      trecho(0);
+    else
+    {
+      vector<thread> threads;
+      for (unsigned t = 0; t < Nt; t++)
+        threads.emplace_back(trecho, t);
+      for (unsigned t = 0; t < Nt; t++)
+        threads[t].join();
+    }
+    INSTR_FASE(SAIDA);
+    for (unsigned t = 0; t < Nt; t++)
+      Out.write(buffer[t].data(), buffer[t].size());
+    Nvetores += Nlidos;
+  } while (ok);
+
+  Out.flush();
+  return ok && Out.good();
+}
@@ -0,0 +1,48 @@
+#ifndef _LOTE_H_
+#define _LOTE_H_
+
+#include <cstdint>
+#include <iostream>
+#include "circuito.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// SIMULACAO EM LOTE
+/// Simula o circuito para uma sequencia de vetores de entrada lida de um stream
+/// (arquivo ou cin), escrevendo as saidas de cada vetor, na mesma ordem, em outro
+/// stream. Os vetores sao lidos em lotes, simulados de 512 em 512 (Bloco3S, ver
+/// Netlist::simular) e as saidas sao escritas antes de ler o lote seguinte: a
+/// memoria usada nao depende do tamanho da entrada.
+/// Formatos dos vetores (de entrada e de saida):
+/// - TEXTO: um vetor por linha, com um caractere por valor (F T ?, ou f t ?),
+///   separados ou nao por espacos; linhas em branco sao ignoradas. As saidas sao
+///   escritas com os valores separados por espacos (F T ?).
+/// - BINARIO: sem cabecalho, um vetor apos o outro, cada um com (N+3)/4 bytes
+///   (N = numero de entradas ou de saidas), na mesma codificacao das linhas da
+///   tabela verdade binaria (ver tabela.h): o valor i fica nos bits 2*(i%4) e
+///   2*(i%4)+1 do byte i/4 (0=UNDEF, 1=FALSE, 2=TRUE; o codigo 3 eh um erro)
+/// ###########################################################################
+
+enum class FormatoLote
+{
+  TEXTO,
+  BINARIO
+};
+
+// Numero padrao de vetores em cada lote
+const unsigned VETORES_LOTE = 64 * 512;
+
+// Simula o circuito C para todos os vetores de In, escrevendo as saidas em Out
+// Cada lote de VetoresLote vetores eh dividido entre NThreads threads (0: uma por
+// nucleo do processador), cada uma com os seus blocos de 512 vetores
+// Nvetores recebe o numero de vetores simulados
+// Em caso de erro de formato, imprime em cerr a mensagem (com a linha, no formato
+// texto) e para; as saidas dos vetores anteriores ao erro jah foram escritas
+// Retorna true se deu tudo OK; false se deu erro (circuito invalido ou entrada invalida)
+bool simularLote(const Circuito &C, std::istream &In, std::ostream &Out,
+                 FormatoLote FormatoIn, FormatoLote FormatoOut, uint64_t &Nvetores,
+                 unsigned VetoresLote = VETORES_LOTE, unsigned NThreads = 1);
+
+#endif // _LOTE_H_
@@ -0,0 +1,433 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "nativo.h"
+#include "binario.h"
+#include "netlist.h"
+#include "instrumentacao.h"
+
+#ifdef NATIVO_DISPONIVEL
+#include <dlfcn.h>
+#include <pwd.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+#endif
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+using namespace std;
+
+/// ***********************
+/// Geracao do codigo C
+/// ***********************
+
+// Numero maximo de portas em cada funcao do codigo gerado: o tempo de compilacao
+// cresce mais que linearmente com o tamanho das funcoes, entao o codigo eh dividido
+// em muitas funcoes pequenas, que o compilador nao deve juntar (noinline)
+static const unsigned PORTAS_FUNCAO_NATIVA = 64;
+
+// A expressao C que calcula a saida da K-esima porta da netlist N
+// Palavras: false para valores bool3S (tabelas-verdade), true para Palavra3S (dual-rail)
+// Nome(S): o nome da variavel que contem o valor do sinal S
+template <class NomeSinal>
+static string expressaoNativa(const Netlist &N, unsigned K, bool Palavras, NomeSinal Nome)
+{
+  static const char *tabela[] = {"", "AND3S", "AND3S", "OR3S", "OR3S", "XOR3S", "XOR3S"};
+  static const char *funcao[] = {"", "pAND", "pAND", "pOR", "pOR", "pXOR", "pXOR"};
+  TipoPorta T = N.getTipo(K);
+  const uint32_t *f = N.getFanin(K);
+  string expr = Nome(f[0]);
+
+  for (unsigned j = 1; j < N.getNumInputsPort(K); j++)
+  {
+    if (Palavras)
+      expr = string(funcao[int(T)]) + "(" + expr + ", " + Nome(f[j]) + ")";
+    else
+      expr = string(tabela[int(T)]) + "[(" + expr + " << 2) | " + Nome(f[j]) + "]";
+  }
+  if (T == TipoPorta::NT || T == TipoPorta::NA || T == TipoPorta::NO || T == TipoPorta::NX)
+    expr = (Palavras ? "pNOT(" + expr + ")" : "NOT3S[" + expr + "]");
+  return expr;
+}
+
+// Escreve a funcao C que simula as portas de K0 a K1-1 da netlist N
+// Cada porta eh calculada diretamente a partir do vetor v e gravada logo em seguida:
+// assim cada valor fica vivo por pouco tempo, o que mantem a compilacao rapida
+// Lacos: true se as portas estao em lacos de realimentacao; nesse caso, a funcao
+// retorna se alguma porta mudou
+static void gerarTrechoNativo(const Netlist &N, unsigned K0, unsigned K1, bool Lacos,
+                              bool Palavras, const string &Nome, std::ostream &O)
+{
+  string tipo = (Palavras ? "palavra3s" : "unsigned char");
+  unsigned NI = N.getNumInputs();
+  auto nome = [](uint32_t S)
+  { return "v[" + to_string(S) + "]"; };
+
+  O << "static __attribute__((noinline)) " << (Lacos ? "int " : "void ") << Nome << "(" << tipo << " *v)\n{\n";
+  if (Lacos)
+    O << "  int mudou = 0;\n  " << tipo << " x;\n";
+  for (unsigned k = K0; k < K1; k++)
+  {
+    string expr = expressaoNativa(N, k, Palavras, nome);
+    string v = nome(NI + k);
+    if (!Lacos)
+      O << "  " << v << " = " << expr << ";\n";
+    else if (Palavras)
+      O << "  x = " << expr << ";\n  mudou |= (x.t != " << v << ".t) | (x.f != " << v
+        << ".f);\n  " << v << " = x;\n";
+    else
+      O << "  x = " << expr << ";\n  mudou |= (x != " << v << ");\n  " << v << " = x;\n";
+  }
+  if (Lacos)
+    O << "  return mudou;\n";
+  O << "}\n\n";
+}
+
+// Escreve uma das versoes (bool3S ou Palavra3S) da simulacao
+static void gerarSimulacaoNativa(const Netlist &N, bool Palavras, std::ostream &O)
+{
+  string tipo = (Palavras ? "palavra3s" : "unsigned char");
+  string sufixo = (Palavras ? "_p" : "_b");
+  string indef = (Palavras ? "UNDEF3S" : "0");
+  unsigned NI = N.getNumInputs();
+  unsigned NP = N.getNumPorts();
+  unsigned NA = N.getNumAciclicas();
+  unsigned Nfunc_acicl = 0, Nfunc_lacos = 0;
+
+  // Parte aciclica: uma funcao para cada trecho de portas
+  for (unsigned k0 = 0; k0 < NA; k0 += PORTAS_FUNCAO_NATIVA, Nfunc_acicl++)
+    gerarTrechoNativo(N, k0, min(NA, k0 + PORTAS_FUNCAO_NATIVA), false, Palavras,
+                      "aciclica" + sufixo + to_string(Nfunc_acicl), O);
+
+  // Parte com realimentacao: cada funcao retorna se alguma porta mudou
+  for (unsigned k0 = NA; k0 < NP; k0 += PORTAS_FUNCAO_NATIVA, Nfunc_lacos++)
+    gerarTrechoNativo(N, k0, min(NP, k0 + PORTAS_FUNCAO_NATIVA), true, Palavras,
+                      "lacos" + sufixo + to_string(Nfunc_lacos), O);
+
+  // A funcao exportada
+  O << "void circ3s_simular" << (Palavras ? "_palavras" : "") << "(const " << tipo << " *in_circ, "
+    << tipo << " *out_circ, " << tipo << " *v)\n{\n";
+  O << "  unsigned i;\n";
+  O << "  for (i = 0; i < " << NI << "; i++)\n    v[i] = in_circ[i];\n";
+  for (unsigned n = 0; n < Nfunc_acicl; n++)
+    O << "  aciclica" << sufixo << n << "(v);\n";
+  if (NA < NP)
+  {
+    O << "  for (i = " << NI + NA << "; i < " << NI + NP << "; i++)\n    v[i] = " << indef << ";\n";
+    O << "  {\n    int mudou;\n    do\n    {\n      mudou = 0;\n";
+    for (unsigned n = 0; n < Nfunc_lacos; n++)
+      O << "      mudou |= lacos" << sufixo << n << "(v);\n";
+    O << "    } while (mudou);\n  }\n";
+  }
+  for (unsigned j = 0; j < N.getNumOutputs(); j++)
+    O << "  out_circ[" << j << "] = v[" << N.getSaida(j) << "];\n";
+  O << "}\n\n";
+}
+
+void gerarCodigoNativo(const Netlist &N, uint64_t Chave, std::ostream &O)
+{
+  using namespace tabelas_bool3S;
+
+  O << "/* Simulacao nativa de circuito (" << N.getNumInputs() << " entradas, "
+    << N.getNumOutputs() << " saidas, " << N.getNumPorts() << " portas) */\n";
+  O << "/* Gerado automaticamente (ver nativo.h): nao deve ser alterado */\n\n";
+  O << "#include <stdint.h>\n\n";
+  O << "const uint64_t circ3s_chave = " << Chave << "ULL;\n";
+  O << "const unsigned circ3s_num_sinais = " << N.getNumSinais() << ";\n\n";
+
+  // As tabelas-verdade de bool3S (as mesmas de bool3S.h)
+  auto tabela = [&O](const char *Nome, const Tabela &T, unsigned Tam)
+  {
+    O << "static const unsigned char " << Nome << "[" << Tam << "] = {";
+    for (unsigned i = 0; i < Tam; i++)
+      O << (i > 0 ? ", " : "") << unsigned(T.valor[i]);
+    O << "};\n";
+  };
+  tabela("NOT3S", NOT, 4);
+  tabela("AND3S", AND, 16);
+  tabela("OR3S", OR, 16);
+  tabela("XOR3S", XOR, 16);
+
+  // Os operadores de Palavra3S (os mesmos de palavra3S.h)
+  O << "\ntypedef struct\n{\n  uint64_t t, f;\n} palavra3s;\n";
+  O << "static const palavra3s UNDEF3S = {0, 0};\n";
+  O << "static inline palavra3s pNOT(palavra3s a)\n{\n  palavra3s r = {a.f, a.t};\n  return r;\n}\n";
+  O << "static inline palavra3s pAND(palavra3s a, palavra3s b)\n{\n"
+       "  palavra3s r = {a.t & b.t, a.f | b.f};\n  return r;\n}\n";
+  O << "static inline palavra3s pOR(palavra3s a, palavra3s b)\n{\n"
+       "  palavra3s r = {a.t | b.t, a.f & b.f};\n  return r;\n}\n";
+  O << "static inline palavra3s pXOR(palavra3s a, palavra3s b)\n{\n"
+       "  palavra3s r = {(a.t & b.f) | (a.f & b.t), (a.t & b.t) | (a.f & b.f)};\n  return r;\n}\n\n";
+
+  gerarSimulacaoNativa(N, false, O);
+  gerarSimulacaoNativa(N, true, O);
+}
+
+/// ***********************
+/// Compilacao e carga
+/// ***********************
+
+// Os argumentos do comando usado para compilar o programa C Fonte na biblioteca Destino
+// (-O1: com -O2 a compilacao de circuitos grandes fica bem mais lenta)
+// O compilador (CC) pode ter varias palavras (ex.: "ccache gcc"), separadas por espacos
+static vector<string> comandoCompilacao(const string &Fonte, const string &Destino)
+{
+  const char *cc = getenv("CC");
+  string prog = (cc != nullptr && cc[0] != '\0' ? cc : "cc");
+  vector<string> args;
+  size_t ini = prog.find_first_not_of(' ');
+  while (ini != string::npos)
+  {
+    size_t fim = prog.find(' ', ini);
+    args.push_back(prog.substr(ini, fim - ini));
+    ini = prog.find_first_not_of(' ', fim);
+  }
+  if (args.empty())
+    args.push_back("cc");
+  for (const char *a : {"-O1", "-shared", "-fPIC", "-o"})
+    args.push_back(a);
+  args.push_back(Destino);
+  args.push_back(Fonte);
+  return args;
+}
+
+#ifdef NATIVO_DISPONIVEL
+// Executa o comando Args (sem passar por um shell: os nomes dos arquivos podem
+// ter quaisquer caracteres) e espera ele terminar
+// Retorna true se o comando terminou com sucesso
+static bool executarCompilador(const vector<string> &Args)
+{
+  vector<char *> argv;
+  for (const string &a : Args)
+    argv.push_back(const_cast<char *>(a.c_str()));
+  argv.push_back(nullptr);
+  pid_t pid;
+  if (posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ) != 0)
+    return false;
+  int estado;
+  while (waitpid(pid, &estado, 0) < 0)
+    if (errno != EINTR)
+      return false;
+  return WIFEXITED(estado) && WEXITSTATUS(estado) == 0;
+}
+
+// O diretorio de cache padrao: CIRCUITO_CACHE, $XDG_CACHE_HOME/circuito3S ou
+// ~/.cache/circuito3S (de cada usuario: nunca um diretorio compartilhado, como o /tmp)
+// Retorna "" se nao houver como saber o diretorio do usuario
+static string diretorioCachePadrao()
+{
+  const char *d = getenv("CIRCUITO_CACHE");
+  if (d != nullptr && d[0] != '\0')
+    return d;
+  d = getenv("XDG_CACHE_HOME");
+  if (d != nullptr && d[0] == '/')
+    return string(d) + "/circuito3S";
+  d = getenv("HOME");
+  if (d == nullptr || d[0] == '\0')
+  {
+    const passwd *pw = getpwuid(getuid());
+    d = (pw != nullptr ? pw->pw_dir : nullptr);
+  }
+  return (d != nullptr && d[0] != '\0' ? string(d) + "/.cache/circuito3S" : "");
+}
+
+// Cria (com permissao 0700) ou confere o diretorio de cache Dir
+// As bibliotecas do cache sao carregadas (e os seus construtores executados) antes
+// de qualquer conferencia do conteudo: por isso o diretorio deve ser do proprio
+// usuario e ninguem mais pode escrever nele
+// Retorna false (e imprime a mensagem em cout) se o diretorio nao for seguro
+static bool prepararDiretorioCache(const string &Dir)
+{
+  error_code erro;
+  filesystem::path pai = filesystem::path(Dir).parent_path();
+  if (!pai.empty())
+    filesystem::create_directories(pai, erro);
+  mkdir(Dir.c_str(), 0700);
+
+  struct stat st;
+  if (stat(Dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
+  {
+    cout << "Erro: Nao foi possivel criar o diretorio de cache " << Dir << endl;
+    return false;
+  }
+  if (st.st_uid != geteuid() || (st.st_mode & (S_IWGRP | S_IWOTH)) != 0)
+  {
+    cout << "Erro: O diretorio de cache " << Dir
+         << " deve pertencer ao usuario e nao ter permissao de escrita para outros\n";
+    return false;
+  }
+  return true;
+}
+#endif
+
+uint64_t SimuladorNativo::calcularChave(const Circuito &C)
+{
+  DescricaoCircuito D;
+  C.descrever(D);
+  string cmd;
+  for (const string &a : comandoCompilacao("", ""))
+    cmd += a + '\0';
+  uint32_t cab[2] = {VERSAO_NATIVO, D.Nin};
+
+  uint64_t H = hashFNV(cab, sizeof(cab));
+  H = hashFNV(D.tipos.data(), D.tipos.size() * sizeof(TipoPorta), H);
+  H = hashFNV(D.inicio.data(), D.inicio.size() * sizeof(uint32_t), H);
+  H = hashFNV(D.id_in.data(), D.id_in.size() * sizeof(int), H);
+  H = hashFNV(D.id_out.data(), D.id_out.size() * sizeof(int), H);
+  return hashFNV(cmd.data(), cmd.size(), H);
+}
+
+SimuladorNativo::SimuladorNativo()
+    : biblioteca(nullptr), f_simular(nullptr), f_simular_palavras(nullptr),
+      Nin(0), Nout(0), Nsinais(0), chave(0), compilou(false)
+{
+}
+
+SimuladorNativo::~SimuladorNativo() { liberar(); }
+
+void SimuladorNativo::liberar()
+{
+#ifdef NATIVO_DISPONIVEL
+  if (biblioteca != nullptr)
+    dlclose(biblioteca);
+#endif
+  biblioteca = nullptr;
+  f_simular = nullptr;
+  f_simular_palavras = nullptr;
+  Nin = Nout = Nsinais = 0;
+  chave = 0;
+}
+
+bool SimuladorNativo::carregar(const Circuito &C, const std::string &DirCache)
+{
+  liberar();
+  compilou = false;
+
+#ifndef NATIVO_DISPONIVEL
+  (void)C;
+  (void)DirCache;
+  cout << "Erro: Simulacao nativa nao disponivel neste sistema\n";
+  return false;
+#else
+  if (!C.valid())
+    return false;
+  const Netlist &N = C.getNetlist();
+  uint64_t H = calcularChave(C);
+  INSTR_FASE(COMPILACAO);
+
+  string dir = (DirCache.empty() ? diretorioCachePadrao() : DirCache);
+  if (dir.empty())
+  {
+    cout << "Erro: Diretorio de cache indefinido (defina CIRCUITO_CACHE)\n";
+    return false;
+  }
+  if (!prepararDiretorioCache(dir))
+    return false;
+
+  char nome[32];
+  snprintf(nome, sizeof(nome), "circ3s_%016llx", (unsigned long long)H);
+  string base = dir + "/" + nome;
+  string arq_so = base + ".so";
+
+  void *bib = dlopen(arq_so.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (bib == nullptr)
+  {
+    // Nao estah no cache: gera, compila e so entao move para o nome definitivo,
+    // para que outro processo nunca carregue uma biblioteca incompleta
+    string sufixo = "." + to_string(getpid()) + "_" + to_string(reinterpret_cast<uintptr_t>(this));
+    string arq_c = base + sufixo + ".c";
+    string arq_tmp = base + sufixo + ".so";
+    {
+      ofstream fonte(arq_c);
+      if (!fonte.is_open())
+      {
+        cout << "Erro: Nao foi possivel criar " << arq_c << endl;
+        return false;
+      }
+      gerarCodigoNativo(N, H, fonte);
+      fonte.close();
+      if (fonte.fail())
+      {
+        cout << "Erro: Nao foi possivel gravar " << arq_c << endl;
+        return false;
+      }
+    }
+    bool ok = executarCompilador(comandoCompilacao(arq_c, arq_tmp));
+    remove(arq_c.c_str());
+    if (!ok || rename(arq_tmp.c_str(), arq_so.c_str()) != 0)
+    {
+      remove(arq_tmp.c_str());
+      cout << "Erro: Falha na compilacao da simulacao nativa\n";
+      return false;
+    }
+    compilou = true;
+    bib = dlopen(arq_so.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (bib == nullptr)
+    {
+      cout << "Erro: " << dlerror() << endl;
+      return false;
+    }
+  }
+
+  // Confere se a biblioteca eh mesmo a deste circuito
+  const uint64_t *ch = static_cast<const uint64_t *>(dlsym(bib, "circ3s_chave"));
+  const unsigned *ns = static_cast<const unsigned *>(dlsym(bib, "circ3s_num_sinais"));
+  void *fs = dlsym(bib, "circ3s_simular");
+  void *fp = dlsym(bib, "circ3s_simular_palavras");
+  if (ch == nullptr || ns == nullptr || fs == nullptr || fp == nullptr ||
+      *ch != H || *ns != N.getNumSinais())
+  {
+    dlclose(bib);
+    cout << "Erro: Biblioteca invalida no cache: " << arq_so << endl;
+    return false;
+  }
+
+  biblioteca = bib;
+  f_simular = reinterpret_cast<FuncaoNativa>(fs);
+  f_simular_palavras = reinterpret_cast<FuncaoNativaPalavras>(fp);
+  Nin = N.getNumInputs();
+  Nout = N.getNumOutputs();
+  Nsinais = N.getNumSinais();
+  chave = H;
+  return true;
+#endif
+}
+
+/// ***********************
+/// SIMULACAO
+/// ***********************
+
+void SimuladorNativo::simular(const bool3S *in_circ, bool3S *out_circ) const
+{
+  // Area de trabalho de cada thread, reaproveitada entre as chamadas
+  INSTR_SIMULACAO();
+  INSTR_FASE(SIMULACAO);
+  if (f_simular == nullptr)
+    return;
+  static thread_local vector<bool3S> valores;
+  if (valores.size() < Nsinais)
+    valores.resize(Nsinais);
+  f_simular(in_circ, out_circ, valores.data());
+}
+
+void SimuladorNativo::simular(const Palavra3S *in_circ, Palavra3S *out_circ) const
+{
+  INSTR_SIMULACAO();
+  INSTR_FASE(SIMULACAO);
+  if (f_simular_palavras == nullptr)
+    return;
+  static thread_local vector<Palavra3S> valores;
+  if (valores.size() < Nsinais)
+    valores.resize(Nsinais);
+  f_simular_palavras(in_circ, out_circ, valores.data());
+}
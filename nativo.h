@@ -0,0 +1,115 @@
+#ifndef _NATIVO_H_
+#define _NATIVO_H_
+
+#include <cstdint>
+#include <string>
+#include "bool3S.h"
+#include "palavra3S.h"
+#include "circuito.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// SIMULACAO NATIVA (COMPILACAO DA NETLIST PARA CODIGO DE MAQUINA)
+/// Para circuitos simulados um numero muito grande de vezes: a netlist eh
+/// traduzida para um programa C (uma instrucao por porta, na ordem de
+/// simulacao, com as portas em lacos simuladas pelo metodo do ponto fixo), que
+/// eh compilado pelo compilador C do sistema como biblioteca dinamica e
+/// carregado (dlopen) no proprio programa.
+/// As bibliotecas ficam guardadas em um diretorio de cache, com um nome que
+/// depende do hash da descricao do circuito (e do comando de compilacao): ao
+/// carregar de novo o mesmo circuito, a compilacao nao eh refeita.
+/// Soh estah disponivel em sistemas POSIX (NATIVO_DISPONIVEL).
+/// Variaveis de ambiente:
+///   CC: o compilador C (padrao: cc), executado diretamente (sem shell)
+///   CIRCUITO_CACHE: o diretorio de cache (padrao: $XDG_CACHE_HOME/circuito3S ou
+///   ~/.cache/circuito3S). Como as bibliotecas do cache sao carregadas no programa,
+///   o diretorio deve pertencer ao usuario e nao ter permissao de escrita para
+///   outros (eh criado com permissao 0700); senao, carregar falha
+/// ###########################################################################
+
+#if defined(__unix__) || defined(__APPLE__)
+#define NATIVO_DISPONIVEL
+#endif
+
+// Versao do codigo gerado (faz parte do hash: mudar invalida o cache)
+const uint32_t VERSAO_NATIVO = 1;
+
+///
+/// CLASSE SIMULADOR NATIVO
+///
+
+class SimuladorNativo
+{
+private:
+  // As funcoes da biblioteca compilada: recebem as entradas, as saidas e uma area de
+  // trabalho com um valor para cada sinal da netlist
+  typedef void (*FuncaoNativa)(const bool3S *, bool3S *, bool3S *);
+  typedef void (*FuncaoNativaPalavras)(const Palavra3S *, Palavra3S *, Palavra3S *);
+
+  // A biblioteca carregada (nullptr se nenhuma)
+  void *biblioteca;
+  FuncaoNativa f_simular;
+  FuncaoNativaPalavras f_simular_palavras;
+
+  unsigned Nin, Nout, Nsinais;
+  // O hash do circuito carregado
+  uint64_t chave;
+  // true se a ultima chamada a carregar precisou compilar (o circuito nao estava no cache)
+  bool compilou;
+
+public:
+  /// ***********************
+  /// Inicializacao e finalizacao
+  /// ***********************
+
+  SimuladorNativo();
+  // Destrutor: apenas chama a funcao liberar()
+  ~SimuladorNativo();
+
+  // Nao pode ser copiado
+  SimuladorNativo(const SimuladorNativo &) = delete;
+  void operator=(const SimuladorNativo &) = delete;
+
+  // Gera, compila (se nao estiver no cache) e carrega a simulacao nativa do circuito C
+  // DirCache: o diretorio de cache (vazio: CIRCUITO_CACHE ou o padrao)
+  // Retorna true se deu tudo OK; false se deu erro (circuito invalido, sistema sem
+  // suporte, falha na compilacao ou no carregamento)
+  bool carregar(const Circuito &C, const std::string &DirCache = "");
+
+  // Descarrega a biblioteca
+  void liberar();
+
+  /// ***********************
+  /// Funcoes de consulta
+  /// ***********************
+
+  bool carregado() const { return biblioteca != nullptr; }
+  // true se a ultima chamada a carregar precisou compilar o circuito
+  bool compilado() const { return compilou; }
+  unsigned getNumInputs() const { return Nin; }
+  unsigned getNumOutputs() const { return Nout; }
+  uint64_t getChave() const { return chave; }
+
+  // Retorna o hash que identifica o circuito C no cache
+  static uint64_t calcularChave(const Circuito &C);
+
+  /// ***********************
+  /// SIMULACAO
+  /// ***********************
+
+  // Simula o circuito carregado para as entradas in_circ (dimensao NumInputs),
+  // guardando as saidas em out_circ (dimensao NumOutputs)
+  // Pode ser chamada ao mesmo tempo por varias threads
+  // Se nenhum circuito estiver carregado (carregado() == false), nao faz nada
+  void simular(const bool3S *in_circ, bool3S *out_circ) const;
+
+  // Idem, para 64 vetores de entrada de uma soh vez (ver palavra3S.h)
+  void simular(const Palavra3S *in_circ, Palavra3S *out_circ) const;
+};
+
+// Escreve em O o programa C com a simulacao nativa da netlist N, identificado pela Chave
+void gerarCodigoNativo(const Netlist &N, uint64_t Chave, std::ostream &O);
+
+#endif // _NATIVO_H_
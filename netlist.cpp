@@ -0,0 +1,551 @@
+#include <cstdint>
+#include <iostream>
+#include "netlist.h"
+#include "bool3S.h"
+#include "simd3S.h"
+#include "instrumentacao.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+using namespace std;
+
+///
+/// CLASSE FILA DE EVENTOS
+///
+
+FilaEventos::FilaEventos() {}
+
+///
+/// CLASSE NETLIST
+///
+
+/// ***********************
+/// Inicializacao e finalizacao
+/// ***********************
+
+Netlist::Netlist()
+    : Nin(0), inicio(1, 0), Nacicl(0), inicio_segmento(1, 0), Nniveis(0), inicio_fanout(1, 0) {}
+
+void Netlist::clear()
+{
+  Nin = 0;
+  tipo.clear();
+  inicio.assign(1, 0);
+  fanin.clear();
+  saida.clear();
+  id_porta.clear();
+  posicao.clear();
+  Nacicl = 0;
+  inicio_segmento.assign(1, 0);
+  laco.clear();
+  segmento.clear();
+  nivel.clear();
+  Nniveis = 0;
+  inicio_fanout.assign(1, 0);
+  fanout.clear();
+}
+
+void Netlist::montar(const DescricaoCircuito &D)
+{
+  montar(D.Nin, D.tipos.size(), D.tipos.data(), D.inicio.data(), D.id_in.data(),
+         D.id_out.size(), D.id_out.data());
+}
+
+void Netlist::montar(unsigned NI, unsigned NP, const TipoPorta *Tipos, const uint32_t *Inicio,
+                     const int32_t *Id_in, unsigned NO, const int32_t *Id_out)
+{
+  clear();
+  Nin = NI;
+
+  // Numero de entradas de cada porta que vem de portas ainda nao ordenadas
+  vector<unsigned> pendentes(NP, 0);
+  // Lista das portas alimentadas por cada porta (fan-out), tambem no formato CSR:
+  // as portas alimentadas pela porta i estao em destino[ini_dest[i]] .. destino[ini_dest[i+1]-1]
+  vector<uint32_t> ini_dest(NP + 1, 0), destino;
+
+  for (unsigned i = 0; i < NP; i++)
+  {
+    for (uint32_t j = Inicio[i]; j < Inicio[i + 1]; j++)
+    {
+      if (Id_in[j] > 0)
+      {
+        pendentes[i]++;
+        ini_dest[Id_in[j]]++;
+      }
+    }
+  }
+  for (unsigned i = 0; i < NP; i++)
+    ini_dest[i + 1] += ini_dest[i];
+  destino.resize(ini_dest[NP]);
+  vector<uint32_t> pos(ini_dest.begin(), ini_dest.end() - 1);
+  for (unsigned i = 0; i < NP; i++)
+  {
+    for (uint32_t j = Inicio[i]; j < Inicio[i + 1]; j++)
+    {
+      if (Id_in[j] > 0)
+        destino[pos[Id_in[j] - 1]++] = i;
+    }
+  }
+
+  // Ordenacao topologica (algoritmo de Kahn): "ordem" funciona como a fila,
+  // comecando pelas portas que soh dependem de entradas do circuito
+  vector<uint32_t> ordem;
+  ordem.reserve(NP);
+  for (unsigned i = 0; i < NP; i++)
+    if (pendentes[i] == 0)
+      ordem.push_back(i);
+  for (unsigned k = 0; k < ordem.size(); k++)
+  {
+    unsigned i = ordem[k];
+    for (uint32_t d = ini_dest[i]; d < ini_dest[i + 1]; d++)
+    {
+      if (--pendentes[destino[d]] == 0)
+        ordem.push_back(destino[d]);
+    }
+  }
+  Nacicl = ordem.size();
+
+  // As portas que sobraram estao em lacos (ou dependem deles)
+  ordenarLacos(ordem, ini_dest, destino);
+
+  // Posicao de cada porta (pela id-1) na ordem de simulacao
+  posicao.resize(NP);
+  for (unsigned k = 0; k < NP; k++)
+    posicao[ordem[k]] = k;
+
+  // Guarda as portas ja na ordem de simulacao, com as entradas convertidas em sinais
+  tipo.resize(NP);
+  id_porta.resize(NP);
+  inicio.resize(NP + 1);
+  fanin.resize(Inicio[NP]);
+  for (unsigned k = 0; k < NP; k++)
+  {
+    unsigned i = ordem[k];
+    tipo[k] = Tipos[i];
+    id_porta[k] = i + 1;
+    inicio[k + 1] = inicio[k] + (Inicio[i + 1] - Inicio[i]);
+    for (uint32_t j = Inicio[i], f = inicio[k]; j < Inicio[i + 1]; j++, f++)
+    {
+      int id = Id_in[j];
+      fanin[f] = (id > 0 ? Nin + posicao[id - 1] : -id - 1);
+    }
+  }
+
+  saida.resize(NO);
+  for (unsigned j = 0; j < NO; j++)
+  {
+    int id = Id_out[j];
+    saida[j] = (id > 0 ? Nin + posicao[id - 1] : -id - 1);
+  }
+
+  // Os niveis da parte aciclica
+  nivel.assign(Nacicl, 0);
+  for (unsigned k = 0; k < Nacicl; k++)
+  {
+    for (uint32_t f = inicio[k]; f < inicio[k + 1]; f++)
+    {
+      if (fanin[f] >= Nin && nivel[fanin[f] - Nin] + 1 > nivel[k])
+        nivel[k] = nivel[fanin[f] - Nin] + 1;
+    }
+    if (nivel[k] + 1 > Nniveis)
+      Nniveis = nivel[k] + 1;
+  }
+
+  // O fan-out de cada sinal
+  inicio_fanout.assign(getNumSinais() + 1, 0);
+  for (uint32_t f = 0; f < fanin.size(); f++)
+    inicio_fanout[fanin[f] + 1]++;
+  for (unsigned S = 0; S < getNumSinais(); S++)
+    inicio_fanout[S + 1] += inicio_fanout[S];
+  fanout.resize(fanin.size());
+  vector<uint32_t> prox(inicio_fanout.begin(), inicio_fanout.end() - 1);
+  for (unsigned k = 0; k < NP; k++)
+    for (uint32_t f = inicio[k]; f < inicio[k + 1]; f++)
+      fanout[prox[fanin[f]]++] = k;
+}
+
+void Netlist::ordenarLacos(std::vector<uint32_t> &Ordem, const std::vector<uint32_t> &Ini_dest,
+                           const std::vector<uint32_t> &Destino)
+{
+  const uint32_t NENHUM = UINT32_MAX;
+  unsigned NP = Ini_dest.size() - 1;
+
+  // Nenhuma porta da parte aciclica eh alimentada por portas das demais: a busca
+  // comecando nas portas que sobraram nunca chega na parte aciclica
+  vector<uint8_t> aciclica(NP, 0);
+  for (uint32_t i : Ordem)
+    aciclica[i] = 1;
+
+  // Componentes fortemente conexas (algoritmo de Tarjan, com a busca em profundidade
+  // sem recursao): indice eh a ordem de descoberta de cada porta e menor eh o menor
+  // indice alcancavel a partir dela que ainda estah na pilha
+  vector<uint32_t> indice(NP, NENHUM), menor(NP);
+  vector<uint8_t> na_pilha(NP, 0);
+  vector<uint32_t> pilha;
+  // A pilha da busca: a porta e a proxima posicao de Destino a seguir
+  vector<pair<uint32_t, uint32_t>> busca;
+  // As componentes, na ordem em que sao encontradas (cada uma depois de todas as que
+  // ela alimenta): as portas da componente C sao comp[ini_comp[C]] .. comp[ini_comp[C+1]-1]
+  vector<uint32_t> comp, ini_comp(1, 0);
+  uint32_t descobertas = 0;
+
+  auto descobrir = [&](uint32_t i)
+  {
+    indice[i] = menor[i] = descobertas++;
+    pilha.push_back(i);
+    na_pilha[i] = 1;
+    busca.push_back({i, Ini_dest[i]});
+  };
+
+  for (unsigned r = 0; r < NP; r++)
+  {
+    if (aciclica[r] || indice[r] != NENHUM)
+      continue;
+    descobrir(r);
+    while (!busca.empty())
+    {
+      uint32_t i = busca.back().first;
+      if (busca.back().second < Ini_dest[i + 1])
+      {
+        uint32_t j = Destino[busca.back().second++];
+        if (indice[j] == NENHUM)
+          descobrir(j);
+        else if (na_pilha[j] && indice[j] < menor[i])
+          menor[i] = indice[j];
+        continue;
+      }
+
+      busca.pop_back();
+      if (!busca.empty() && menor[i] < menor[busca.back().first])
+        menor[busca.back().first] = menor[i];
+      if (menor[i] == indice[i])
+      {
+        // i eh a raiz de uma componente: as portas da pilha a partir dela,
+        // na ordem de descoberta
+        size_t p = pilha.size();
+        do
+          na_pilha[pilha[--p]] = 0;
+        while (pilha[p] != i);
+        comp.insert(comp.end(), pilha.begin() + p, pilha.end());
+        ini_comp.push_back(comp.size());
+        pilha.resize(p);
+      }
+    }
+  }
+
+  // As componentes em ordem topologica (a inversa da encontrada), divididas em
+  // segmentos: cada laco eh um segmento, e as portas fora de lacos consecutivas
+  // ficam juntas em um soh segmento
+  inicio_segmento.clear();
+  laco.clear();
+  segmento.clear();
+  for (unsigned C = ini_comp.size() - 1; C-- > 0;)
+  {
+    uint32_t ini = ini_comp[C], fim = ini_comp[C + 1];
+    bool e_laco = (fim - ini > 1);
+    for (uint32_t d = Ini_dest[comp[ini]]; !e_laco && d < Ini_dest[comp[ini] + 1]; d++)
+      e_laco = (Destino[d] == comp[ini]);
+    if (e_laco || laco.empty() || laco.back())
+    {
+      inicio_segmento.push_back(Ordem.size());
+      laco.push_back(e_laco);
+    }
+    for (uint32_t p = ini; p < fim; p++)
+    {
+      segmento.push_back(laco.size() - 1);
+      Ordem.push_back(comp[p]);
+    }
+  }
+  inicio_segmento.push_back(Ordem.size());
+}
+
+/// ***********************
+/// Funcoes de consulta
+/// ***********************
+
+uint32_t Netlist::sinal(int IdOrig) const
+{
+  if (IdOrig < 0)
+    return -IdOrig - 1;
+  return Nin + posicao[IdOrig - 1];
+}
+
+int Netlist::idOrig(uint32_t S) const
+{
+  if (S < Nin)
+    return -int(S) - 1;
+  return id_porta[S - Nin];
+}
+
+/// ***********************
+/// SIMULACAO
+/// ***********************
+
+// Os valores todos indefinidos e o teste de valor todo definido, para cada tipo de valor
+static void tornarIndefinido(bool3S &S) { S = bool3S::UNDEF; }
+static void tornarIndefinido(Palavra3S &S) { S = palavraUNDEF(); }
+static void tornarIndefinido(Bloco3S &S) { S = blocoUNDEF(); }
+static bool definido(bool3S S) { return S != bool3S::UNDEF; }
+static bool definido(const Palavra3S &S) { return (S.t | S.f) == ~uint64_t(0); }
+static bool definido(const Bloco3S &S)
+{
+  uint64_t def = ~uint64_t(0);
+  for (unsigned w = 0; w < PALAVRAS_BLOCO3S; w++)
+    def &= S.t[w] | S.f[w];
+  return def == ~uint64_t(0);
+}
+
+bool3S Netlist::avaliar(unsigned K, const bool3S *valores) const
+{
+  const uint32_t *f = getFanin(K);
+  bool3S S = avaliarPorta<bool3S>(tipo[K], getNumInputsPort(K),
+                                  [f, valores](unsigned j) { return valores[f[j]]; });
+  INSTR_AVALIACAO(tipo[K], S);
+  return S;
+}
+
+template <class V, class Calcular>
+unsigned Netlist::simularSegmento(unsigned Seg, V *out_port, Calcular Calc) const
+{
+  uint32_t K0 = inicio_segmento[Seg], K1 = inicio_segmento[Seg + 1];
+  if (!laco[Seg])
+  {
+    for (uint32_t k = K0; k < K1; k++)
+      out_port[k] = Calc(k);
+    return K1 - K0;
+  }
+
+  // A lista de trabalho (uma pilha) e a marcacao das portas do laco que estao nela
+  // Area de trabalho de cada thread, reaproveitada entre as chamadas
+  static thread_local vector<uint32_t> lista;
+  static thread_local vector<uint8_t> na_lista;
+  lista.clear();
+  na_lista.assign(K1 - K0, 1);
+  for (uint32_t k = K1; k-- > K0;)
+  {
+    tornarIndefinido(out_port[k]);
+    lista.push_back(k);
+  }
+
+  unsigned Navaliadas = 0;
+  while (!lista.empty())
+  {
+    uint32_t k = lista.back();
+    lista.pop_back();
+    na_lista[k - K0] = 0;
+    V S = Calc(k);
+    Navaliadas++;
+    if (S != out_port[k])
+    {
+      out_port[k] = S;
+      // As portas do laco alimentadas por esta, que ainda podem mudar
+      uint32_t Sk = Nin + k;
+      for (uint32_t d = inicio_fanout[Sk]; d < inicio_fanout[Sk + 1]; d++)
+      {
+        uint32_t k2 = fanout[d];
+        if (k2 >= K0 && k2 < K1 && !na_lista[k2 - K0] && !definido(out_port[k2]))
+        {
+          na_lista[k2 - K0] = 1;
+          lista.push_back(k2);
+        }
+      }
+    }
+  }
+  INSTR_REAVALIACOES(Navaliadas - (K1 - K0));
+  return Navaliadas;
+}
+
+unsigned Netlist::simularLacos(bool3S *valores) const
+{
+  unsigned Navaliadas = 0;
+  auto calcular = [this, valores](unsigned K) { return avaliar(K, valores); };
+  for (unsigned s = 0; s < getNumSegmentos(); s++)
+    Navaliadas += simularSegmento(s, valores + Nin, calcular);
+  return Navaliadas;
+}
+
+unsigned Netlist::simular(const bool3S *in_circ, bool3S *valores) const
+{
+  INSTR_SIMULACAO();
+  INSTR_FASE(SIMULACAO);
+  bool3S *out_port = valores + Nin;
+
+  for (unsigned i = 0; i < Nin; i++)
+    valores[i] = in_circ[i];
+
+  // Parte aciclica: cada porta eh simulada uma unica vez, depois de todas
+  // as portas das quais depende
+  for (unsigned k = 0; k < Nacicl; k++)
+    out_port[k] = avaliar(k, valores);
+
+  // Parte com realimentacao: um segmento de cada vez
+  return simularLacos(valores);
+}
+
+unsigned Netlist::resimular(const bool3S *in_circ, const uint32_t *Alteradas, unsigned N,
+                            bool3S *valores, FilaEventos &Fila) const
+{
+  INSTR_SIMULACAO();
+  INSTR_FASE(SIMULACAO);
+  bool3S *out_port = valores + Nin;
+  unsigned Nsegmentos = getNumSegmentos();
+  unsigned primeiro_segmento = Nsegmentos;
+  unsigned Navaliadas = 0;
+
+  Fila.nivel.resize(Nniveis);
+  Fila.na_fila.resize(getNumPorts(), 0);
+  Fila.segmento_alterado.resize(Nsegmentos, 0);
+
+  // Coloca na fila as portas alimentadas pelo sinal S (as da parte com
+  // realimentacao sao marcadas pelo segmento)
+  auto propagar = [&](uint32_t S)
+  {
+    for (uint32_t d = inicio_fanout[S]; d < inicio_fanout[S + 1]; d++)
+    {
+      uint32_t k = fanout[d];
+      if (k >= Nacicl)
+      {
+        unsigned s = segmento[k - Nacicl];
+        Fila.segmento_alterado[s] = 1;
+        if (s < primeiro_segmento)
+          primeiro_segmento = s;
+      }
+      else if (!Fila.na_fila[k])
+      {
+        Fila.na_fila[k] = 1;
+        Fila.nivel[nivel[k]].push_back(k);
+      }
+    }
+  };
+
+  for (unsigned i = 0; i < N; i++)
+  {
+    uint32_t S = Alteradas[i];
+    if (valores[S] != in_circ[S])
+    {
+      valores[S] = in_circ[S];
+      propagar(S);
+    }
+  }
+
+  // As portas de um nivel soh alimentam portas de niveis maiores
+  for (unsigned l = 0; l < Nniveis; l++)
+  {
+    vector<uint32_t> &fila = Fila.nivel[l];
+    for (unsigned q = 0; q < fila.size(); q++)
+    {
+      uint32_t k = fila[q];
+      Fila.na_fila[k] = 0;
+      Navaliadas++;
+      bool3S S = avaliar(k, valores);
+      if (S != out_port[k])
+      {
+        out_port[k] = S;
+        propagar(Nin + k);
+      }
+    }
+    fila.clear();
+  }
+
+  // Nenhuma porta aciclica depende da parte com realimentacao, que fica no final,
+  // e cada segmento soh alimenta ele mesmo e os seguintes
+  auto calcular = [this, valores](unsigned K) { return avaliar(K, valores); };
+  for (unsigned s = primeiro_segmento; s < Nsegmentos; s++)
+  {
+    if (!Fila.segmento_alterado[s])
+      continue;
+    Fila.segmento_alterado[s] = 0;
+    uint32_t K0 = inicio_segmento[s], K1 = inicio_segmento[s + 1];
+    Fila.anteriores.assign(out_port + K0, out_port + K1);
+    Navaliadas += simularSegmento(s, out_port, calcular);
+    for (uint32_t k = K0; k < K1; k++)
+    {
+      if (out_port[k] == Fila.anteriores[k - K0])
+        continue;
+      for (uint32_t d = inicio_fanout[Nin + k]; d < inicio_fanout[Nin + k + 1]; d++)
+      {
+        unsigned s2 = segmento[fanout[d] - Nacicl];
+        if (s2 != s)
+          Fila.segmento_alterado[s2] = 1;
+      }
+    }
+  }
+  return Navaliadas;
+}
+
+Palavra3S Netlist::avaliar(unsigned K, const Palavra3S *valores) const
+{
+  const uint32_t *f = getFanin(K);
+  Palavra3S S = avaliarPorta<Palavra3S>(tipo[K], getNumInputsPort(K),
+                                        [f, valores](unsigned j) { return valores[f[j]]; });
+  INSTR_AVALIACAO(tipo[K], S);
+  return S;
+}
+
+void Netlist::simular(const Palavra3S *in_circ, Palavra3S *valores) const
+{
+  INSTR_SIMULACAO();
+  INSTR_FASE(SIMULACAO);
+  Palavra3S *out_port = valores + Nin;
+
+  for (unsigned i = 0; i < Nin; i++)
+    valores[i] = in_circ[i];
+
+  for (unsigned k = 0; k < Nacicl; k++)
+    out_port[k] = avaliar(k, valores);
+
+  // Parte com realimentacao: como cada bit indefinido soh pode passar a ser
+  // definido (e nunca o contrario), cada laco chega ao ponto fixo
+  auto calcular = [this, valores](unsigned K) { return avaliar(K, valores); };
+  for (unsigned s = 0; s < getNumSegmentos(); s++)
+    simularSegmento(s, out_port, calcular);
+}
+
+void Netlist::simular(const Bloco3S *in_circ, Bloco3S *valores) const
+{
+  INSTR_SIMULACAO();
+  INSTR_FASE(SIMULACAO);
+  Bloco3S *out_port = valores + Nin;
+  AvaliadorBloco avaliarBloco = getAvaliadorBloco();
+
+  for (unsigned i = 0; i < Nin; i++)
+    valores[i] = in_circ[i];
+
+  for (unsigned k = 0; k < Nacicl; k++)
+  {
+    avaliarBloco(tipo[k], getFanin(k), getNumInputsPort(k), valores, out_port[k]);
+    INSTR_AVALIACAO(tipo[k], out_port[k]);
+  }
+
+  auto calcular = [this, valores, avaliarBloco](unsigned K)
+  {
+    Bloco3S S;
+    avaliarBloco(tipo[K], getFanin(K), getNumInputsPort(K), valores, S);
+    INSTR_AVALIACAO(tipo[K], S);
+    return S;
+  };
+  for (unsigned s = 0; s < getNumSegmentos(); s++)
+    simularSegmento(s, out_port, calcular);
+}
+
+void Netlist::diagnosticarLacos(const bool3S *valores, std::vector<DiagnosticoLaco> &D) const
+{
+  const bool3S *out_port = valores + Nin;
+  D.clear();
+  for (unsigned s = 0; s < getNumSegmentos(); s++)
+  {
+    if (!laco[s])
+      continue;
+    DiagnosticoLaco L = {s, getNumPortsSegmento(s), 0, 0};
+    for (uint32_t k = inicio_segmento[s]; k < inicio_segmento[s + 1]; k++)
+    {
+      if (out_port[k] != bool3S::UNDEF)
+        continue;
+      if (L.Nindefinidas++ == 0)
+        L.IdPorta = id_porta[k];
+    }
+    if (L.Nindefinidas > 0)
+      D.push_back(L);
+  }
+}
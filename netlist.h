@@ -0,0 +1,263 @@
+#ifndef _NETLIST_H_
+#define _NETLIST_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "bool3S.h"
+#include "palavra3S.h"
+#include "avaliador.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// A NETLIST COMPILADA
+/// Representacao compacta de um circuito, usada na simulacao: em vez de um
+/// vetor de ponteiros para portas alocadas separadamente, cada uma com o seu
+/// proprio vetor id_in, guarda todas as portas em poucos vetores contiguos.
+///
+/// ATENCAO PARA A CONVENCAO DOS INDICES USADOS NA NETLIST:
+/// unsigned K: posicao de uma porta na ordem de simulacao: de 0 a NumPorts-1
+/// uint32_t S: sinal (posicao no vetor de valores): de 0 a NumSinais-1
+///   - sinais de 0 a NumInputs-1: as entradas do circuito (id -1 eh o sinal 0, etc.)
+///   - sinal NumInputs+K: a saida da K-esima porta na ordem de simulacao
+/// ###########################################################################
+
+// Descricao de um circuito no formato das ids (o mesmo dos arquivos), usada para
+// montar netlists e circuitos e para trocar circuitos entre os modulos:
+// - Nin: numero de entradas do circuito
+// - tipos: o tipo da porta de id i+1 eh tipos[i]
+// - inicio e id_in: as ids de origem das entradas da porta de id i+1 sao
+//   id_in[inicio[i]] .. id_in[inicio[i+1]-1] (inicio tem dimensao NumPorts+1)
+// - id_out: a id de origem de cada saida do circuito
+struct DescricaoCircuito
+{
+  unsigned Nin;
+  std::vector<TipoPorta> tipos;
+  std::vector<uint32_t> inicio;
+  std::vector<int> id_in;
+  std::vector<int> id_out;
+};
+
+// Resultado do diagnostico de um laco de realimentacao depois de uma simulacao
+// (ver Netlist::diagnosticarLacos)
+struct DiagnosticoLaco
+{
+  unsigned segmento;     // o segmento do laco (ver Netlist::getNumSegmentos)
+  unsigned Nportas;      // numero de portas do laco
+  unsigned Nindefinidas; // portas do laco cuja saida ficou indefinida
+  unsigned IdPorta;      // id (no circuito original) da primeira porta indefinida
+};
+
+///
+/// CLASSE FILA DE EVENTOS
+///
+
+// Estruturas auxiliares da simulacao incremental (ver Netlist::resimular):
+// as portas que precisam ser reavaliadas, separadas por nivel
+// Ficam fora da netlist para que ela possa ser compartilhada (soh para leitura)
+// por varias threads, cada uma com a sua fila
+class FilaEventos
+{
+private:
+  // As portas a reavaliar de cada nivel
+  std::vector<std::vector<uint32_t>> nivel;
+  // na_fila[K] != 0 se a K-esima porta jah estah na fila
+  std::vector<uint8_t> na_fila;
+  // Os segmentos da parte com realimentacao a resimular (!= 0) e os valores
+  // anteriores das portas do segmento sendo resimulado
+  std::vector<uint8_t> segmento_alterado;
+  std::vector<bool3S> anteriores;
+
+  friend class Netlist;
+
+public:
+  FilaEventos();
+};
+
+///
+/// CLASSE NETLIST
+///
+
+class Netlist
+{
+private:
+  /// ***********************
+  /// Dados
+  /// ***********************
+
+  // Numero de entradas do circuito
+  unsigned Nin;
+
+  // O tipo de cada porta, na ordem de simulacao
+  std::vector<TipoPorta> tipo;
+
+  // As entradas das portas, no formato CSR (compressed sparse row):
+  // os sinais que alimentam a K-esima porta sao fanin[inicio[K]] .. fanin[inicio[K+1]-1]
+  std::vector<uint32_t> inicio; // dimensao NumPorts+1
+  std::vector<uint32_t> fanin;
+
+  // O sinal de origem de cada saida do circuito
+  std::vector<uint32_t> saida;
+
+  // A id (de 1 a NumPorts) que a K-esima porta tinha no circuito original
+  std::vector<uint32_t> id_porta;
+  // A posicao na ordem de simulacao da porta que tinha id i+1 no circuito original
+  std::vector<uint32_t> posicao;
+
+  // Numero de portas da parte aciclica: as portas de 0 a Nacicl-1 estao em ordem
+  // topologica e sao simuladas uma unica vez; as demais estao em lacos de
+  // realimentacao (ou dependem deles)
+  unsigned Nacicl;
+
+  // A parte com realimentacao eh dividida em segmentos consecutivos, em ordem
+  // topologica (cada segmento soh depende da parte aciclica e dos anteriores):
+  // - um laco: uma componente fortemente conexa do grafo das portas (mais de uma
+  //   porta, ou uma porta que alimenta a si mesma), simulado pelo metodo do ponto
+  //   fixo, soh com as portas do laco;
+  // - ou uma sequencia de portas fora de lacos (que dependem de lacos anteriores),
+  //   em ordem topologica, simuladas uma unica vez
+  // As portas do segmento S sao as de inicio_segmento[S] a inicio_segmento[S+1]-1
+  std::vector<uint32_t> inicio_segmento; // dimensao NumSegmentos+1
+  std::vector<uint8_t> laco;             // laco[S] != 0 se o segmento S eh um laco
+  std::vector<uint32_t> segmento;        // o segmento da K-esima porta em segmento[K-Nacicl]
+
+  // O nivel de cada porta da parte aciclica: 0 se soh depende de entradas do circuito,
+  // ou 1 + o maior nivel das portas que a alimentam
+  std::vector<uint32_t> nivel;
+  unsigned Nniveis;
+
+  // As portas alimentadas por cada sinal (fan-out), no formato CSR:
+  // o sinal S alimenta as portas fanout[inicio_fanout[S]] .. fanout[inicio_fanout[S+1]-1]
+  std::vector<uint32_t> inicio_fanout; // dimensao NumSinais+1
+  std::vector<uint32_t> fanout;
+
+  // Ordena a parte com realimentacao (as portas que sobraram na ordenacao topologica,
+  // em Ordem a partir de Nacicl) e a divide em segmentos (algoritmo de Tarjan)
+  // Destino e Ini_dest: as portas alimentadas por cada porta (pelas posicoes originais)
+  void ordenarLacos(std::vector<uint32_t> &Ordem, const std::vector<uint32_t> &Ini_dest,
+                    const std::vector<uint32_t> &Destino);
+
+  // Simula o segmento Seg da parte com realimentacao, para valores do tipo V (bool3S,
+  // Palavra3S ou Bloco3S); Calcular(K) retorna a saida da K-esima porta
+  // Nos lacos, as portas comecam indefinidas e sao reavaliadas (lista de trabalho)
+  // ateh que nenhuma mude: uma porta soh volta para a lista quando alguma porta do
+  // mesmo laco que a alimenta muda de valor, e nunca se a sua saida jah estiver
+  // toda definida (os valores indefinidos soh podem passar a definidos)
+  // Retorna o numero de portas avaliadas
+  template <class V, class Calcular>
+  unsigned simularSegmento(unsigned Seg, V *out_port, Calcular Calc) const;
+
+  // Simula toda a parte com realimentacao (portas de Nacicl em diante)
+  // Retorna o numero de portas avaliadas
+  unsigned simularLacos(bool3S *valores) const;
+
+  // Calcula a saida da K-esima porta a partir dos valores atuais dos sinais
+  bool3S avaliar(unsigned K, const bool3S *valores) const;
+  // Idem, para 64 vetores de entrada ao mesmo tempo
+  Palavra3S avaliar(unsigned K, const Palavra3S *valores) const;
+
+public:
+  /// ***********************
+  /// Inicializacao e finalizacao
+  /// ***********************
+
+  // Cria uma netlist vazia
+  Netlist();
+
+  // Limpa todo o conteudo da netlist
+  void clear();
+
+  // Monta a netlist a partir da descricao de um circuito valido (ver DescricaoCircuito)
+  // Calcula a ordem de simulacao das portas (ordem topologica por niveis, com as
+  // portas em lacos ao final) e guarda as portas ja nessa ordem
+  // Nao testa os dados, que devem vir de um circuito valido (Circuito::valid)
+  void montar(const DescricaoCircuito &D);
+
+  // Idem, com a descricao em arrays (p.ex. diretamente de um arquivo mapeado em memoria):
+  // NI entradas, NP portas (Tipos e Inicio com dimensoes NP e NP+1) e NO saidas (Id_out)
+  void montar(unsigned NI, unsigned NP, const TipoPorta *Tipos, const uint32_t *Inicio,
+              const int32_t *Id_in, unsigned NO, const int32_t *Id_out);
+
+  /// ***********************
+  /// Funcoes de consulta
+  /// ***********************
+
+  unsigned getNumInputs() const { return Nin; }
+  unsigned getNumOutputs() const { return saida.size(); }
+  unsigned getNumPorts() const { return tipo.size(); }
+  // Numero total de sinais (entradas do circuito + saidas das portas)
+  unsigned getNumSinais() const { return Nin + tipo.size(); }
+  // Numero de portas da parte aciclica (as primeiras na ordem de simulacao)
+  unsigned getNumAciclicas() const { return Nacicl; }
+  // Numero de niveis da parte aciclica
+  unsigned getNumNiveis() const { return Nniveis; }
+
+  // Caracteristicas da K-esima porta na ordem de simulacao
+  TipoPorta getTipo(unsigned K) const { return tipo[K]; }
+  unsigned getNumInputsPort(unsigned K) const { return inicio[K + 1] - inicio[K]; }
+  const uint32_t *getFanin(unsigned K) const { return fanin.data() + inicio[K]; }
+  unsigned getIdPort(unsigned K) const { return id_porta[K]; }
+
+  // Nivel da K-esima porta (K < NumAciclicas)
+  unsigned getNivel(unsigned K) const { return nivel[K]; }
+
+  // Os segmentos da parte com realimentacao (ver inicio_segmento)
+  unsigned getNumSegmentos() const { return laco.size(); }
+  unsigned getInicioSegmento(unsigned S) const { return inicio_segmento[S]; }
+  unsigned getNumPortsSegmento(unsigned S) const { return inicio_segmento[S + 1] - inicio_segmento[S]; }
+  bool segmentoLaco(unsigned S) const { return laco[S] != 0; }
+
+  // As portas alimentadas pelo sinal S
+  unsigned getNumFanout(uint32_t S) const { return inicio_fanout[S + 1] - inicio_fanout[S]; }
+  const uint32_t *getFanout(uint32_t S) const { return fanout.data() + inicio_fanout[S]; }
+
+  // O sinal de origem da J-esima saida do circuito (J de 0 a NumOutputs-1)
+  uint32_t getSaida(unsigned J) const { return saida[J]; }
+
+  // Converte uma id de origem (de entrada do circuito ou de porta) no sinal correspondente
+  uint32_t sinal(int IdOrig) const;
+  // Converte um sinal na id de origem correspondente (de -1 a -NumInputs ou de 1 a NumPorts)
+  int idOrig(uint32_t S) const;
+
+  /// ***********************
+  /// SIMULACAO
+  /// ***********************
+
+  // Simula o circuito para as entradas in_circ (dimensao NumInputs)
+  // O vetor valores (dimensao NumSinais) recebe os valores de todos os sinais:
+  // as entradas do circuito seguidas das saidas das portas, na ordem de simulacao
+  // Retorna o numero de portas avaliadas na parte com realimentacao
+  unsigned simular(const bool3S *in_circ, bool3S *valores) const;
+
+  // Simulacao incremental (orientada a eventos): atualiza valores, que deve conter o
+  // resultado de uma simulacao anterior, para as novas entradas in_circ, sabendo que
+  // soh as entradas cujos sinais estao em Alteradas (N sinais) podem ter mudado.
+  // Soh reavalia as portas alcancadas pelas entradas alteradas (o cone de fan-out),
+  // nivel a nivel, e para de propagar em cada porta cuja saida nao mudou.
+  // Na parte com realimentacao, cada segmento alcancado eh todo simulado de novo,
+  // e a propagacao continua para os segmentos seguintes soh se alguma saida mudou.
+  // Retorna o numero de portas reavaliadas
+  unsigned resimular(const bool3S *in_circ, const uint32_t *Alteradas, unsigned N,
+                     bool3S *valores, FilaEventos &Fila) const;
+
+  // Simula o circuito para 64 vetores de entrada de uma soh vez (ver palavra3S.h):
+  // o B-esimo bit de in_circ[i] eh o valor da entrada i no B-esimo vetor
+  // O vetor valores (dimensao NumSinais) recebe os valores de todos os sinais
+  // para os 64 vetores, na mesma organizacao da funcao anterior
+  void simular(const Palavra3S *in_circ, Palavra3S *valores) const;
+
+  // Idem, para 512 vetores de entrada de uma soh vez (ver Bloco3S em palavra3S.h)
+  // Usa o kernel vetorial (AVX2, AVX-512 ou escalar) escolhido em simd3S.h
+  void simular(const Bloco3S *in_circ, Bloco3S *valores) const;
+
+  // Diagnostico dos lacos de realimentacao depois de uma simulacao (valores como
+  // calculados por simular): preenche D com os lacos em que alguma porta ficou
+  // indefinida. Na logica de 3 estados os valores nunca oscilam (soh passam de
+  // indefinidos a definidos), e o ponto fixo sempre existe: um laco sem valor
+  // estavel (p.ex. um NOT que alimenta a si mesmo) fica indefinido
+  void diagnosticarLacos(const bool3S *valores, std::vector<DiagnosticoLaco> &D) const;
+};
+
+#endif // _NETLIST_H_
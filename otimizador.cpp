@@ -0,0 +1,370 @@
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "otimizador.h"
+#include "netlist.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+using namespace std;
+
+// Hash de uma porta do tipo T com as N entradas de ids Id_in
+static uint64_t hashPorta(TipoPorta T, const int *Id_in, unsigned N)
+{
+  uint64_t H = 0xcbf29ce484222325ULL ^ uint64_t(T);
+  for (unsigned j = 0; j < N; j++)
+    H = (H ^ uint32_t(Id_in[j])) * 0x100000001b3ULL;
+  return H ^ (H >> 29);
+}
+
+bool otimizarCircuito(const Circuito &C, Circuito &Otimizado, EstatisticasOtimizacao *E)
+{
+  EstatisticasOtimizacao est = {};
+  Otimizado.clear();
+  if (!C.valid())
+    return false;
+
+  const Netlist &N = C.getNetlist();
+  unsigned NP = N.getNumPorts();
+  est.portas_antes = NP;
+
+  // Para cada porta (pela id): repr eh a id de origem que a substitui (ela mesma,
+  // se for mantida); as portas mantidas tem o tipo e as entradas em tipo, ini,
+  // tam e entradas (entradas[ini[id]] .. entradas[ini[id]+tam[id]-1], jah com os
+  // representantes, exceto se resolvida[id] == 0)
+  vector<int> repr(NP + 1, 0);
+  vector<uint8_t> processada(NP + 1, 0), resolvida(NP + 1, 0);
+  vector<TipoPorta> tipo(NP + 1, TipoPorta::NT);
+  vector<uint32_t> ini(NP + 1, 0), tam(NP + 1, 0);
+  vector<int> entradas;
+  // As portas mantidas e resolvidas, pelo hash
+  unordered_multimap<uint64_t, int> tabela;
+  tabela.reserve(NP);
+
+  auto guardar = [&](int Id, TipoPorta T, const vector<int> &In)
+  {
+    tipo[Id] = T;
+    ini[Id] = entradas.size();
+    tam[Id] = In.size();
+    entradas.insert(entradas.end(), In.begin(), In.end());
+  };
+
+  // As portas na ordem de simulacao: as entradas de cada porta (exceto nos lacos)
+  // jah foram processadas
+  vector<int> in;
+  for (unsigned k = 0; k < NP; k++)
+  {
+    int id = N.getIdPort(k);
+    TipoPorta T = N.getTipo(k);
+    bool pronta = true;
+    in.clear();
+    for (unsigned j = 0; j < N.getNumInputsPort(k); j++)
+    {
+      int orig = N.idOrig(N.getFanin(k)[j]);
+      if (orig > 0 && !processada[orig])
+        pronta = false;
+      in.push_back(orig > 0 && processada[orig] ? repr[orig] : orig);
+    }
+    processada[id] = 1;
+    repr[id] = id;
+
+    // Porta em laco com entrada ainda nao processada: fica como estah
+    if (!pronta)
+    {
+      guardar(id, T, in);
+      continue;
+    }
+
+    // Entradas em ordem; sem repeticoes, exceto nas XOR e NXOR
+    sort(in.begin(), in.end());
+    if (T != TipoPorta::XO && T != TipoPorta::NX && T != TipoPorta::NT)
+    {
+      size_t n = in.size();
+      in.erase(unique(in.begin(), in.end()), in.end());
+      est.entradas_repetidas += n - in.size();
+      if (in.size() == 1)
+      {
+        est.fios++;
+        if (T == TipoPorta::AN || T == TipoPorta::OR)
+        {
+          repr[id] = in[0];
+          continue;
+        }
+        T = TipoPorta::NT;
+      }
+    }
+
+    // NOT de NOT
+    if (T == TipoPorta::NT && in[0] > 0 && tipo[in[0]] == TipoPorta::NT && resolvida[in[0]])
+    {
+      repr[id] = entradas[ini[in[0]]];
+      est.negacoes_duplas++;
+      continue;
+    }
+
+    // Porta igual a uma anterior
+    uint64_t H = hashPorta(T, in.data(), in.size());
+    auto faixa = tabela.equal_range(H);
+    for (auto it = faixa.first; it != faixa.second && repr[id] == id; ++it)
+    {
+      int c = it->second;
+      if (tipo[c] == T && tam[c] == in.size() && equal(in.begin(), in.end(), entradas.begin() + ini[c]))
+        repr[id] = c;
+    }
+    if (repr[id] != id)
+    {
+      est.duplicadas++;
+      continue;
+    }
+    guardar(id, T, in);
+    resolvida[id] = 1;
+    tabela.emplace(H, id);
+  }
+
+  // O representante final de uma id de origem (uma porta substituida pode ter sido
+  // substituida por outra que depois tambem foi)
+  auto representante = [&](int Id)
+  {
+    while (Id > 0 && repr[Id] != Id)
+      Id = repr[Id];
+    return Id;
+  };
+
+  // As portas dos lacos que nao foram resolvidas soh agora tem os representantes de
+  // todas as entradas. Repete a busca de portas iguais entre todas as portas mantidas
+  // (com as entradas em ordem e atualizadas) ateh que nenhuma porta seja substituida:
+  // cada substituicao pode tornar iguais outras portas que usam as substituidas
+  bool mudou = true;
+  while (mudou)
+  {
+    mudou = false;
+    tabela.clear();
+    for (int id = 1; id <= int(NP); id++)
+    {
+      if (repr[id] != id)
+        continue;
+      TipoPorta T = tipo[id];
+      in.clear();
+      for (uint32_t j = ini[id]; j < ini[id] + tam[id]; j++)
+        in.push_back(representante(entradas[j]));
+      sort(in.begin(), in.end());
+      // Sem repeticoes, exceto nas XOR e NXOR, se restarem pelo menos duas entradas
+      // (as portas de uma entrada soh sao eliminadas na primeira passagem)
+      if (T != TipoPorta::XO && T != TipoPorta::NX && T != TipoPorta::NT)
+      {
+        size_t distintas = 1;
+        for (size_t j = 1; j < in.size(); j++)
+          distintas += (in[j] != in[j - 1]);
+        if (distintas >= 2 && distintas < in.size())
+        {
+          est.entradas_repetidas += in.size() - distintas;
+          in.erase(unique(in.begin(), in.end()), in.end());
+        }
+      }
+      copy(in.begin(), in.end(), entradas.begin() + ini[id]);
+      tam[id] = in.size();
+
+      uint64_t H = hashPorta(T, in.data(), in.size());
+      auto faixa = tabela.equal_range(H);
+      for (auto it = faixa.first; it != faixa.second && repr[id] == id; ++it)
+      {
+        int c = it->second;
+        if (tipo[c] == T && tam[c] == in.size() && equal(in.begin(), in.end(), entradas.begin() + ini[c]))
+          repr[id] = c;
+      }
+      if (repr[id] != id)
+      {
+        est.duplicadas++;
+        mudou = true;
+        continue;
+      }
+      tabela.emplace(H, id);
+    }
+  }
+
+  // As portas que alimentam alguma saida (busca a partir das saidas)
+  vector<int> id_out(C.getNumOutputs());
+  vector<uint8_t> viva(NP + 1, 0);
+  vector<int> pilha;
+  for (unsigned j = 0; j < id_out.size(); j++)
+  {
+    int orig = C.getIdOutput(j + 1);
+    id_out[j] = representante(orig);
+    if (id_out[j] > 0 && !viva[id_out[j]])
+    {
+      viva[id_out[j]] = 1;
+      pilha.push_back(id_out[j]);
+    }
+  }
+  while (!pilha.empty())
+  {
+    int id = pilha.back();
+    pilha.pop_back();
+    for (uint32_t j = ini[id]; j < ini[id] + tam[id]; j++)
+    {
+      int orig = entradas[j];
+      if (orig > 0 && !viva[orig])
+      {
+        viva[orig] = 1;
+        pilha.push_back(orig);
+      }
+    }
+  }
+
+  // Renumera as portas vivas, na ordem das ids originais
+  vector<int> nova_id(NP + 1, 0);
+  DescricaoCircuito D;
+  D.Nin = C.getNumInputs();
+  D.inicio.push_back(0);
+  for (int id = 1; id <= int(NP); id++)
+  {
+    if (repr[id] != id)
+      continue;
+    if (!viva[id])
+    {
+      est.mortas++;
+      continue;
+    }
+    nova_id[id] = D.tipos.size() + 1;
+    D.tipos.push_back(tipo[id]);
+    D.inicio.push_back(D.inicio.back() + tam[id]);
+  }
+  D.id_in.reserve(D.inicio.back());
+  for (int id = 1; id <= int(NP); id++)
+    if (nova_id[id] != 0)
+      for (uint32_t j = ini[id]; j < ini[id] + tam[id]; j++)
+        D.id_in.push_back(entradas[j] > 0 ? nova_id[entradas[j]] : entradas[j]);
+  for (int orig : id_out)
+    D.id_out.push_back(orig > 0 ? nova_id[orig] : orig);
+
+  // Um circuito precisa de pelo menos uma porta
+  if (D.tipos.empty())
+  {
+    D.tipos.push_back(TipoPorta::NT);
+    D.inicio.push_back(1);
+    D.id_in.push_back(-1);
+  }
+
+  est.portas_depois = D.tipos.size();
+  if (E != nullptr)
+    *E = est;
+  return Otimizado.definir(D);
+}
+
+bool especializarCircuito(const Circuito &C, const std::vector<bool3S> &Fixas, Circuito &Especializado,
+                          std::vector<int> &Entradas, EstatisticasOtimizacao *E)
+{
+  Especializado.clear();
+  Entradas.clear();
+  if (!C.valid() || Fixas.size() != C.getNumInputs())
+    return false;
+
+  // Simulacao com as entradas livres indefinidas: os sinais definidos sao constantes
+  const Netlist &N = C.getNetlist();
+  ContextoSimulacao Ctx;
+  C.simular(Fixas, Ctx);
+  const vector<bool3S> &valor = Ctx.getValores();
+  unsigned NP = N.getNumPorts();
+  auto constante = [&](int IdOrig) { return valor[N.sinal(IdOrig)] != bool3S::UNDEF; };
+
+  // As entradas livres e a entrada fixa que pode gerar as constantes
+  vector<int> nova_entrada(C.getNumInputs() + 1, 0);
+  int fixa = 0;
+  for (unsigned i = 0; i < C.getNumInputs(); i++)
+  {
+    if (Fixas[i] == bool3S::UNDEF)
+    {
+      Entradas.push_back(-int(i + 1));
+      nova_entrada[i + 1] = -int(Entradas.size());
+    }
+    else if (fixa == 0)
+      fixa = -int(i + 1);
+  }
+  bool usa_fixa = Entradas.empty();
+  for (unsigned j = 0; j < C.getNumOutputs(); j++)
+    usa_fixa = usa_fixa || constante(C.getIdOutput(j + 1));
+  if (usa_fixa)
+  {
+    Entradas.push_back(fixa);
+    nova_entrada[-fixa] = -int(Entradas.size());
+  }
+
+  // O circuito especializado, com as mesmas ids de portas (as constantes viram NOT
+  // da entrada fixa, e somem na otimizacao se nao forem usadas). Uma porta que fica
+  // com uma entrada vira AND(x, x) (um fio, eliminado na otimizacao) ou NOT
+  DescricaoCircuito D;
+  D.Nin = Entradas.size();
+  D.inicio.push_back(0);
+  unsigned Nconstantes = 0;
+  vector<int> in;
+  for (int id = 1; id <= int(NP); id++)
+  {
+    TipoPorta T = N.getTipo(N.sinal(id) - C.getNumInputs());
+    if (constante(id))
+    {
+      Nconstantes++;
+      T = TipoPorta::NT;
+      in.assign(1, (usa_fixa ? nova_entrada[-fixa] : -1));
+    }
+    else
+    {
+      // Nas AND, NAND, OR e NOR, as entradas constantes sao o elemento neutro (senao
+      // a porta seria constante); nas XOR e NXOR, cada TRUE inverte a saida
+      bool negar = false;
+      in.clear();
+      for (unsigned j = 0; j < C.getNumInputsPort(id); j++)
+      {
+        int orig = C.getId_inPort(id, j);
+        if (!constante(orig))
+          in.push_back(orig > 0 ? orig : nova_entrada[-orig]);
+        else if (valor[N.sinal(orig)] == bool3S::TRUE)
+          negar = !negar;
+      }
+      if (negar && (T == TipoPorta::XO || T == TipoPorta::NX))
+        T = (T == TipoPorta::XO ? TipoPorta::NX : TipoPorta::XO);
+      if (in.size() == 1 && T != TipoPorta::NT)
+      {
+        bool inverte = (T == TipoPorta::NA || T == TipoPorta::NO || T == TipoPorta::NX);
+        T = (inverte ? TipoPorta::NT : TipoPorta::AN);
+        if (!inverte)
+          in.push_back(in[0]);
+      }
+    }
+    D.tipos.push_back(T);
+    D.id_in.insert(D.id_in.end(), in.begin(), in.end());
+    D.inicio.push_back(D.id_in.size());
+  }
+
+  // As saidas constantes vem da entrada fixa (ou de um NOT dela)
+  for (unsigned j = 0; j < C.getNumOutputs(); j++)
+  {
+    int orig = C.getIdOutput(j + 1);
+    if (!constante(orig))
+      D.id_out.push_back(orig > 0 ? orig : nova_entrada[-orig]);
+    else if (valor[N.sinal(orig)] == Fixas[-fixa - 1])
+      D.id_out.push_back(nova_entrada[-fixa]);
+    else
+    {
+      // Um NOT da entrada fixa, que eh o que as portas constantes viraram
+      D.id_out.push_back(D.tipos.size() + 1);
+      D.tipos.push_back(TipoPorta::NT);
+      D.id_in.push_back(nova_entrada[-fixa]);
+      D.inicio.push_back(D.id_in.size());
+    }
+  }
+
+  Circuito parcial;
+  if (!parcial.definir(D) || !otimizarCircuito(parcial, Especializado, E))
+  {
+    Entradas.clear();
+    return false;
+  }
+  if (E != nullptr)
+  {
+    E->portas_antes = NP;
+    E->constantes = Nconstantes;
+  }
+  return true;
+}
@@ -0,0 +1,70 @@
+#ifndef _OTIMIZADOR_H_
+#define _OTIMIZADOR_H_
+
+#include "circuito.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// OTIMIZACAO ESTRUTURAL DE CIRCUITOS
+/// Gera um circuito equivalente (as mesmas saidas para quaisquer entradas,
+/// inclusive indefinidas) e em geral menor, que simula mais rapido:
+/// - portas duplicadas (mesmo tipo e mesmas entradas, em qualquer ordem) sao
+///   substituidas por uma soh (hash estrutural, "structural hashing");
+/// - entradas repetidas de AND, NAND, OR e NOR sao eliminadas (a AND a = a, mesmo
+///   com a indefinido); nas XOR e NXOR nao (a XOR a eh indefinido se a for);
+///   a porta que fica com uma soh entrada vira um fio (AND, OR) ou um NOT (NAND, NOR);
+/// - NOT de NOT eh substituido pelo sinal original;
+/// - portas que nao alimentam (direta ou indiretamente) nenhuma saida sao removidas.
+/// As portas que sobram sao renumeradas, na ordem das ids originais.
+/// As portas em lacos de realimentacao tambem sao otimizadas, desde que todas as
+/// suas entradas venham de portas ja processadas (na ordem de simulacao).
+///
+/// Tambem especializa um circuito para uma configuracao em que parte das entradas
+/// tem valores fixos (propagacao de constantes), gerando um circuito soh com as
+/// entradas livres, para ser simulado repetidamente nessa configuracao.
+/// ###########################################################################
+
+#include <vector>
+#include "bool3S.h"
+
+// O que foi feito por otimizarCircuito
+struct EstatisticasOtimizacao
+{
+  unsigned portas_antes;
+  unsigned portas_depois;
+  unsigned duplicadas;         // portas substituidas por uma igual
+  unsigned negacoes_duplas;    // NOT de NOT substituidos pelo sinal original
+  unsigned entradas_repetidas; // entradas repetidas eliminadas
+  unsigned fios;               // portas que ficaram com uma entrada (viraram fios ou NOT)
+  unsigned mortas;             // portas que nao alimentam nenhuma saida
+  unsigned constantes;         // portas com saida constante (soh em especializarCircuito)
+};
+
+// Preenche Otimizado com o circuito C otimizado e, se E != nullptr, as estatisticas
+// Se nenhuma porta alimentar as saidas (todas vem de entradas do circuito), o
+// circuito otimizado fica com uma unica porta (um NOT da primeira entrada), pois
+// um circuito precisa ter ao menos uma porta
+// Retorna false se C nao for valido (Otimizado fica vazio)
+bool otimizarCircuito(const Circuito &C, Circuito &Otimizado, EstatisticasOtimizacao *E = nullptr);
+
+// Especializa o circuito C para as entradas fixas em Fixas (dimensao NumInputs):
+// Fixas[i] TRUE ou FALSE fixa o valor da entrada de id -(i+1); UNDEF a deixa livre
+// As constantes sao propagadas pela semantica de 3 estados de cada porta: como as
+// portas sao monotonas, toda porta cuja saida eh definida quando as entradas livres
+// sao UNDEF tem essa saida para quaisquer valores das entradas livres (inclusive nos
+// lacos de realimentacao). Essas portas sao eliminadas; nas demais, as entradas
+// constantes sao eliminadas (TRUE na AND, FALSE na OR e na XOR) ou trocam o tipo
+// da porta (TRUE na XOR: vira NXOR), e o resultado eh otimizado (otimizarCircuito).
+// Especializado fica com as entradas livres, na ordem. Como nenhuma porta gera uma
+// constante a partir de entradas indefinidas, se alguma saida for constante (ou se
+// nao houver entradas livres), uma das entradas fixas eh mantida, ao final, e deve
+// continuar recebendo o seu valor fixo nas simulacoes.
+// Entradas recebe, para cada entrada de Especializado, a id da entrada correspondente
+// do circuito C (de -1 a -NumInputs)
+// Retorna false se C nao for valido ou Fixas tiver dimensao errada (Especializado fica vazio)
+bool especializarCircuito(const Circuito &C, const std::vector<bool3S> &Fixas, Circuito &Especializado,
+                          std::vector<int> &Entradas, EstatisticasOtimizacao *E = nullptr);
+
+#endif // _OTIMIZADOR_H_
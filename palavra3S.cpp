@@ -0,0 +1,57 @@
+#include "palavra3S.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+using namespace std;
+
+bool3S getBool3S(const Palavra3S &P, unsigned B)
+{
+  if ((P.t >> B) & 1)
+    return bool3S::TRUE;
+  if ((P.f >> B) & 1)
+    return bool3S::FALSE;
+  return bool3S::UNDEF;
+}
+
+void setBool3S(Palavra3S &P, unsigned B, bool3S x)
+{
+  uint64_t mask = uint64_t(1) << B;
+  P.t &= ~mask;
+  P.f &= ~mask;
+  if (x == bool3S::TRUE)
+    P.t |= mask;
+  else if (x == bool3S::FALSE)
+    P.f |= mask;
+}
+
+Bloco3S blocoUNDEF()
+{
+  Bloco3S P;
+  for (unsigned w = 0; w < PALAVRAS_BLOCO3S; w++)
+  {
+    P.t[w] = 0;
+    P.f[w] = 0;
+  }
+  return P;
+}
+
+bool3S getBool3S(const Bloco3S &P, unsigned B)
+{
+  return getBool3S(getPalavra3S(P, B / BITS_PALAVRA3S), B % BITS_PALAVRA3S);
+}
+
+void setBool3S(Bloco3S &P, unsigned B, bool3S x)
+{
+  Palavra3S W = getPalavra3S(P, B / BITS_PALAVRA3S);
+  setBool3S(W, B % BITS_PALAVRA3S, x);
+  setPalavra3S(P, B / BITS_PALAVRA3S, W);
+}
+
+bool operator==(const Bloco3S &P1, const Bloco3S &P2)
+{
+  uint64_t dif = 0;
+  for (unsigned w = 0; w < PALAVRAS_BLOCO3S; w++)
+    dif |= (P1.t[w] ^ P2.t[w]) | (P1.f[w] ^ P2.f[w]);
+  return dif == 0;
+}
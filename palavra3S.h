@@ -0,0 +1,109 @@
+#ifndef _PALAVRA3S_H_
+#define _PALAVRA3S_H_
+
+#include <cstdint>
+#include "bool3S.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// PALAVRA3S: 64 valores bool3S empacotados em duas palavras de 64 bits
+/// (codificacao "dual-rail"): o bit B do plano t vale 1 se o B-esimo valor
+/// eh TRUE; o bit B do plano f vale 1 se o B-esimo valor eh FALSE; se os dois
+/// bits valem 0, o valor eh UNDEF (os dois bits nunca valem 1 ao mesmo tempo).
+/// Com essa codificacao, os operadores logicos da classe bool3S sao calculados
+/// para os 64 valores de uma soh vez, com poucas operacoes bit a bit.
+/// ###########################################################################
+
+struct Palavra3S
+{
+  uint64_t t; // bits dos valores TRUE
+  uint64_t f; // bits dos valores FALSE
+};
+
+// Numero de valores bool3S em uma Palavra3S
+const unsigned BITS_PALAVRA3S = 64;
+
+// Uma palavra com os 64 valores UNDEF
+constexpr Palavra3S palavraUNDEF() { return Palavra3S{0, 0}; }
+
+// Consulta e alteracao do B-esimo valor (B de 0 a 63)
+bool3S getBool3S(const Palavra3S &P, unsigned B);
+void setBool3S(Palavra3S &P, unsigned B, bool3S x);
+
+constexpr bool operator==(const Palavra3S &P1, const Palavra3S &P2)
+{
+  return P1.t == P2.t && P1.f == P2.f;
+}
+constexpr bool operator!=(const Palavra3S &P1, const Palavra3S &P2)
+{
+  return !(P1 == P2);
+}
+
+// Os operadores logicos, equivalentes aos da classe bool3S, aplicados bit a bit
+
+// NOT 3S: troca TRUE por FALSE
+constexpr Palavra3S operator~(const Palavra3S &P)
+{
+  return Palavra3S{P.f, P.t};
+}
+// AND 3S: TRUE se os dois TRUE; FALSE se algum FALSE
+constexpr Palavra3S operator&(const Palavra3S &P1, const Palavra3S &P2)
+{
+  return Palavra3S{P1.t & P2.t, P1.f | P2.f};
+}
+// OR 3S: TRUE se algum TRUE; FALSE se os dois FALSE
+constexpr Palavra3S operator|(const Palavra3S &P1, const Palavra3S &P2)
+{
+  return Palavra3S{P1.t | P2.t, P1.f & P2.f};
+}
+// XOR 3S: definido soh se os dois definidos
+constexpr Palavra3S operator^(const Palavra3S &P1, const Palavra3S &P2)
+{
+  return Palavra3S{(P1.t & P2.f) | (P1.f & P2.t), (P1.t & P2.t) | (P1.f & P2.f)};
+}
+
+/// ###########################################################################
+/// BLOCO3S: 512 valores bool3S, na mesma codificacao dual-rail, em 8 palavras
+/// de 64 bits por plano. Eh a unidade de trabalho dos kernels vetoriais
+/// (AVX2/AVX-512, ver simd3S.h): o B-esimo valor do bloco estah no bit B%64
+/// da palavra B/64 dos planos t e f.
+/// ###########################################################################
+
+// Numero de palavras de 64 bits em cada plano de um Bloco3S
+const unsigned PALAVRAS_BLOCO3S = 8;
+// Numero de valores bool3S em um Bloco3S
+const unsigned BITS_BLOCO3S = PALAVRAS_BLOCO3S * BITS_PALAVRA3S;
+
+struct alignas(64) Bloco3S
+{
+  uint64_t t[PALAVRAS_BLOCO3S]; // bits dos valores TRUE
+  uint64_t f[PALAVRAS_BLOCO3S]; // bits dos valores FALSE
+};
+
+// Um bloco com os 512 valores UNDEF
+Bloco3S blocoUNDEF();
+
+// Consulta e alteracao do B-esimo valor (B de 0 a 511)
+bool3S getBool3S(const Bloco3S &P, unsigned B);
+void setBool3S(Bloco3S &P, unsigned B, bool3S x);
+
+// Consulta e alteracao da W-esima Palavra3S do bloco (W de 0 a 7)
+inline Palavra3S getPalavra3S(const Bloco3S &P, unsigned W)
+{
+  return Palavra3S{P.t[W], P.f[W]};
+}
+inline void setPalavra3S(Bloco3S &P, unsigned W, const Palavra3S &x)
+{
+  P.t[W] = x.t;
+  P.f[W] = x.f;
+}
+
+bool operator==(const Bloco3S &P1, const Bloco3S &P2);
+inline bool operator!=(const Bloco3S &P1, const Bloco3S &P2)
+{
+  return !(P1 == P2);
+}
+
+#endif // _PALAVRA3S_H_
@@ -1,13 +1,34 @@
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 #include "port.h"
 #include "bool3S.h"
+#include "instrumentacao.h"
 
 // Bernardo Fonseca Andrade de Lima
 // Francisco de Assis Vilela Neto
 
 using namespace std;
 
+//
+// CLASSE ARENA DE PORTAS
+//
+
+// Tamanho minimo de cada bloco da arena, em bytes
+static const size_t BLOCO_MINIMO_ARENA = 4096;
+
+ArenaPortas::ArenaPortas(size_t Previsto)
+    : recurso(new std::pmr::monotonic_buffer_resource(max(Previsto, BLOCO_MINIMO_ARENA)))
+{
+}
+
+void ArenaPortas::liberar(size_t Previsto)
+{
+  // Recria o recurso, em vez de apenas chamar release(), para que o primeiro bloco
+  // tenha o tamanho previsto
+  recurso.reset(new std::pmr::monotonic_buffer_resource(max(Previsto, BLOCO_MINIMO_ARENA)));
+}
+
 //
 // CLASSE PORT
 //
@@ -19,7 +40,8 @@ using namespace std;
 // Construtor (recebe como parametro o numero de entradas da porta)
 // Dimensiona o array id_in e inicializa elementos com valor invalido (0),
 // inicializa out_port com UNDEF
-Port::Port(unsigned NI) : id_in(NI, 0), out_port(bool3S::UNDEF)
+Port::Port(TipoPorta T, unsigned NI, std::pmr::memory_resource *MR)
+    : id_in(NI, 0, MR), out_port(bool3S::UNDEF), tipo(T)
 {
   // Nao pode testar o parametro NI com validNumInputs pq o construtor de
   // Port eh chamado pelo construtor de Port_NOT, mas sem que ocorra
@@ -35,7 +57,8 @@ Port::Port(unsigned NI) : id_in(NI, 0), out_port(bool3S::UNDEF)
 }
 
 // Construtor por copia
-Port::Port(const Port &P) : id_in(P.id_in), out_port(P.out_port)
+Port::Port(const Port &P, std::pmr::memory_resource *MR)
+    : id_in(P.id_in, MR), out_port(P.out_port), tipo(P.tipo)
 {
 }
 
@@ -236,14 +259,34 @@ std::ostream &operator<<(std::ostream &O, const Port &X)
   return (&X)->imprimir(O);
 };
 
+/// ***********************
+/// SIMULACAO (funcao principal da porta)
+/// ***********************
+
+// Simula uma porta logica de qualquer tipo, pelo avaliador de portas (ver avaliador.h)
+void Port::simular(const std::vector<bool3S> &in_port)
+{
+  if (in_port.size() != getNumInputs() || in_port.empty())
+  {
+    out_port = bool3S::UNDEF;
+    return;
+  }
+  out_port = avaliarPorta(tipo, in_port.data(), in_port.size());
+  INSTR_AVALIACAO(tipo, out_port);
+}
+
 ///
 /// AS OUTRAS PORTS
 ///
 
 /// ==================== PORT NOT ======================
-Port_NOT::Port_NOT() : Port(1){};
+Port_NOT::Port_NOT(std::pmr::memory_resource *MR) : Port(TipoPorta::NT, 1, MR){};
+
+Port_NOT::Port_NOT(const Port_NOT &P, std::pmr::memory_resource *MR) : Port(P, MR){};
+
+ptr_Port Port_NOT::clone() const { return new Port_NOT(*this); };
 
-ptr_Port Port_NOT::clone() const { return new Port_NOT(); };
+ptr_Port Port_NOT::clone(ArenaPortas &A) const { return A.criar<Port_NOT>(*this); };
 
 string Port_NOT::getName() const
 {
@@ -267,265 +310,95 @@ void Port_NOT::digitar()
   }
 }
 
-void Port_NOT::simular(const std::vector<bool3S> &in_port)
-{
-  if (in_port.size() != getNumInputs())
-  {
-    out_port = bool3S::UNDEF;
-    return;
-  }
-  out_port = ~in_port.at(0); // ou ~in_port[0];
-}
 
 /// ==================== PORT AND ======================
 
-Port_AND::Port_AND() : Port(){};
+Port_AND::Port_AND(std::pmr::memory_resource *MR) : Port(TipoPorta::AN, 2, MR){};
+
+Port_AND::Port_AND(const Port_AND &P, std::pmr::memory_resource *MR) : Port(P, MR){};
 
 ptr_Port Port_AND::clone() const { return new Port_AND(*this); };
 
+ptr_Port Port_AND::clone(ArenaPortas &A) const { return A.criar<Port_AND>(*this); };
+
 string Port_AND::getName() const
 {
   return "AN";
 }
 
-void Port_AND::simular(const std::vector<bool3S> &in_port)
-{
-  if (in_port.size() != getNumInputs())
-  {
-    out_port = bool3S::UNDEF;
-    return;
-  }
-
-  out_port = in_port[0];
-  if (out_port == bool3S::FALSE || out_port == bool3S::UNDEF)
-  {
-    return;
-  }
-
-  for (unsigned i = 0; i < getNumInputs(); i++)
-  {
-    if (validIndex(i + 1))
-    {
-      out_port &= in_port[i + 1];
-      if (out_port == bool3S::FALSE)
-      {
-        break;
-        return;
-      }
-    }
-  }
-  if (out_port == bool3S::UNDEF)
-  {
-    return;
-  }
-  out_port = bool3S::TRUE;
-}
 
 /// ==================== PORT NAND ======================
-Port_NAND::Port_NAND() : Port(){};
+Port_NAND::Port_NAND(std::pmr::memory_resource *MR) : Port(TipoPorta::NA, 2, MR){};
+
+Port_NAND::Port_NAND(const Port_NAND &P, std::pmr::memory_resource *MR) : Port(P, MR){};
 
 ptr_Port Port_NAND::clone() const { return new Port_NAND(*this); };
 
+ptr_Port Port_NAND::clone(ArenaPortas &A) const { return A.criar<Port_NAND>(*this); };
+
 string Port_NAND::getName() const
 {
   return "NA";
 }
 
-void Port_NAND::simular(const std::vector<bool3S> &in_port)
-{
-  if (in_port.size() != getNumInputs())
-  {
-    out_port = bool3S::UNDEF;
-    return;
-  }
-
-  out_port = in_port[0];
-  if (out_port == bool3S::FALSE || out_port == bool3S::UNDEF)
-  {
-    out_port = bool3S::TRUE;
-    return;
-  }
-
-  for (unsigned i = 0; i < getNumInputs(); i++)
-  {
-    if (validIndex(i + 1))
-    {
-      out_port &= in_port[i + 1];
-      if (out_port == bool3S::FALSE)
-      {
-        out_port = bool3S::TRUE;
-        break;
-        return;
-      }
-    }
-  }
-  if (out_port == bool3S::UNDEF)
-  {
-    return;
-  }
-  out_port = bool3S::FALSE;
-}
 
 /// ==================== PORT OR ======================
-Port_OR::Port_OR() : Port(){};
+Port_OR::Port_OR(std::pmr::memory_resource *MR) : Port(TipoPorta::OR, 2, MR){};
+
+Port_OR::Port_OR(const Port_OR &P, std::pmr::memory_resource *MR) : Port(P, MR){};
 
 ptr_Port Port_OR::clone() const { return new Port_OR(*this); };
 
+ptr_Port Port_OR::clone(ArenaPortas &A) const { return A.criar<Port_OR>(*this); };
+
 string Port_OR::getName() const
 {
   return "OR";
 }
 
-void Port_OR::simular(const std::vector<bool3S> &in_port)
-{
-  if (in_port.size() != getNumInputs())
-  {
-    out_port = bool3S::UNDEF;
-    return;
-  }
-
-  out_port = in_port[0];
-  if (out_port == bool3S::TRUE)
-  {
-    return;
-  }
-
-  for (unsigned i = 0; i < getNumInputs(); i++)
-  {
-    if (validIndex(i + 1))
-    {
-      out_port |= in_port[i + 1];
-      if (out_port == bool3S::TRUE)
-      {
-        break;
-        return;
-      }
-    }
-  }
-  if (out_port == bool3S::UNDEF)
-  {
-    return;
-  }
-  out_port = bool3S::FALSE;
-}
 
 /// ==================== PORT NOR ======================
-Port_NOR::Port_NOR() : Port(){};
+Port_NOR::Port_NOR(std::pmr::memory_resource *MR) : Port(TipoPorta::NO, 2, MR){};
+
+Port_NOR::Port_NOR(const Port_NOR &P, std::pmr::memory_resource *MR) : Port(P, MR){};
 
 ptr_Port Port_NOR::clone() const { return new Port_NOR(*this); };
 
+ptr_Port Port_NOR::clone(ArenaPortas &A) const { return A.criar<Port_NOR>(*this); };
+
 string Port_NOR::getName() const
 {
   return "NO";
 }
 
-void Port_NOR::simular(const std::vector<bool3S> &in_port)
-{
-  if (in_port.size() != getNumInputs())
-  {
-    out_port = bool3S::UNDEF;
-    return;
-  }
-
-  unsigned possuiUNDEF = 0;
-  out_port = in_port[0];
-  if (out_port == bool3S::TRUE)
-  {
-    out_port = bool3S::FALSE;
-    return;
-  }
-
-  for (unsigned i = 0; i < getNumInputs(); i++)
-  {
-    if (validIndex(i + 1))
-    {
-      out_port |= in_port[i + 1];
-      if (out_port == bool3S::TRUE)
-      {
-        out_port = bool3S::FALSE;
-        break;
-        return;
-      }
-      if (out_port == bool3S::UNDEF)
-      {
-        possuiUNDEF++;
-      }
-    }
-  }
-  if (out_port == bool3S::UNDEF)
-  {
-    return;
-  }
-  out_port = bool3S::TRUE;
-}
 
 /// ==================== PORT XOR ======================
-Port_XOR::Port_XOR() : Port(){};
+Port_XOR::Port_XOR(std::pmr::memory_resource *MR) : Port(TipoPorta::XO, 2, MR){};
+
+Port_XOR::Port_XOR(const Port_XOR &P, std::pmr::memory_resource *MR) : Port(P, MR){};
 
 ptr_Port Port_XOR::clone() const { return new Port_XOR(*this); };
 
+ptr_Port Port_XOR::clone(ArenaPortas &A) const { return A.criar<Port_XOR>(*this); };
+
 string Port_XOR::getName() const
 {
   return "XO";
 }
 
-void Port_XOR::simular(const std::vector<bool3S> &in_port)
-{
-  if (in_port.size() != getNumInputs())
-  {
-    out_port = bool3S::UNDEF;
-    return;
-  }
-
-  out_port = in_port[0];
-  // Exemplo de XOR
-  // 0 1 0 0 1
-  // 1 0 0 1
-  // 1 0 1
-  // 1 1
-  // 0
-  for (unsigned i = 0; i < getNumInputs(); i++)
-  {
-    if (validIndex(i + 1))
-    {
-      out_port ^= in_port[i + 1];
-    }
-  }
-}
 
 /// ==================== PORT NXOR ======================
 
-Port_NXOR::Port_NXOR() : Port(){};
+Port_NXOR::Port_NXOR(std::pmr::memory_resource *MR) : Port(TipoPorta::NX, 2, MR){};
+
+Port_NXOR::Port_NXOR(const Port_NXOR &P, std::pmr::memory_resource *MR) : Port(P, MR){};
 
 ptr_Port Port_NXOR::clone() const { return new Port_NXOR(*this); };
 
+ptr_Port Port_NXOR::clone(ArenaPortas &A) const { return A.criar<Port_NXOR>(*this); };
+
 string Port_NXOR::getName() const
 {
   return "NX";
 }
 
-void Port_NXOR::simular(const std::vector<bool3S> &in_port)
-{
-  if (in_port.size() != getNumInputs())
-  {
-    out_port = bool3S::UNDEF;
-    return;
-  }
-
-  out_port = in_port[0];
-  // Exemplo de NXOR
-  // 0 1 0 0 1
-  // 1 0 0 1
-  // 1 0 1
-  // 1 1
-  // 0
-  // 1
-  for (unsigned i = 0; i < getNumInputs(); i++)
-  {
-    if (validIndex(i))
-    {
-      out_port ^= in_port[i + 1];
-    }
-  }
-  out_port = ~out_port;
-}
@@ -1,10 +1,15 @@
 #ifndef _PORT_H_
 #define _PORT_H_
 
+#include <cstddef>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <utility>
 #include <vector>
 #include "bool3S.h"
+#include "avaliador.h"
 
 // Bernardo Fonseca Andrade de Lima
 // Francisco de Assis Vilela Neto
@@ -14,6 +19,47 @@
 /// unsigned I: indice (de entrada de porta): de 0 a NInputs-1
 /// ###########################################################################
 
+//
+// A CLASSE ARENA DE PORTAS
+//
+
+// Area de memoria (arena) onde um circuito cria todas as suas portas e os vetores
+// id_in delas. Cada alocacao apenas avanca um ponteiro dentro de grandes blocos
+// (std::pmr::monotonic_buffer_resource), e toda a memoria eh liberada de uma soh vez.
+// ATENCAO: as portas criadas na arena nao devem ser liberadas com delete. Os seus
+// destrutores nao sao chamados, o que nao eh necessario, pois toda a memoria que
+// elas usam (inclusive a de id_in) estah na propria arena.
+class ArenaPortas
+{
+private:
+  std::unique_ptr<std::pmr::monotonic_buffer_resource> recurso;
+
+public:
+  // Cria uma arena vazia
+  // Previsto: numero de bytes estimado para as alocacoes (tamanho do primeiro bloco)
+  ArenaPortas(size_t Previsto = 0);
+
+  // Nao pode ser copiada (as portas de um circuito sao clonadas para a arena do outro)
+  ArenaPortas(const ArenaPortas &) = delete;
+  void operator=(const ArenaPortas &) = delete;
+
+  // O recurso de memoria usado pelos vetores (std::pmr) dos objetos da arena
+  std::pmr::memory_resource *getRecurso() const { return recurso.get(); }
+
+  // Libera de uma vez toda a memoria da arena: todos os objetos criados nela deixam de existir
+  // Previsto: numero de bytes estimado para as proximas alocacoes (0 se desconhecido)
+  void liberar(size_t Previsto = 0);
+
+  // Cria na arena um objeto do tipo T (uma porta), passando para o construtor os
+  // argumentos A, seguidos do recurso de memoria da arena
+  template <class T, class... Args>
+  T *criar(Args &&...A)
+  {
+    void *p = recurso->allocate(sizeof(T), alignof(T));
+    return new (p) T(std::forward<Args>(A)..., getRecurso());
+  }
+};
+
 //
 // A CLASSE PORT
 //
@@ -35,21 +81,27 @@ protected:
   // se id_in[i]<0: a i-esima entrada da porta vem da entrada do circuito cuja id eh o
   // valor desse elemento do array
   // se id_in[i]==0: a i-esima entrada da porta estah indefinida
-  std::vector<int> id_in;
+  // A memoria do vetor vem do recurso passado ao construtor (a arena do circuito, se
+  // a porta foi criada em uma ArenaPortas; o heap, caso contrario)
+  std::pmr::vector<int> id_in;
   // O valor logico (bool3S) da saida da porta (?, F ou T)
   bool3S out_port;
+  // O tipo da porta, fixado pelo construtor de cada classe derivada
+  // Permite consultar o tipo e simular a porta sem chamar funcoes virtuais
+  TipoPorta tipo;
 
 public:
   /// ***********************
   /// Inicializacao e finalizacao
   /// ***********************
 
-  // Construtor (recebe como parametro o numero de entradas da porta)
+  // Construtor (recebe como parametro o tipo e o numero de entradas da porta)
   // Testa o parametro (validNumInputs), dimensiona e inicializa os elementos
   // do array id_in com valor invalido (0), inicializa out_port com UNDEF
-  Port(unsigned NI = 2); // ===== FEITO =====
-  // Construtor por copia
-  Port(const Port &); // ===== FEITO =====
+  // MR eh o recurso de onde vem a memoria de id_in
+  Port(TipoPorta T, unsigned NI = 2, std::pmr::memory_resource *MR = std::pmr::get_default_resource()); // ===== FEITO =====
+  // Construtor por copia (id_in eh copiado para o recurso MR)
+  Port(const Port &P, std::pmr::memory_resource *MR = std::pmr::get_default_resource()); // ===== FEITO =====
   // Destrutor virtual
   virtual ~Port(); // ===== FEITO =====
 
@@ -57,8 +109,12 @@ public:
   // uma copia de si mesma, do tipo correto.
   // Por exemplo, se for chamada com um objeto Port_AND, retorna um ponteiro que aponta para
   // uma area que contem uma Port_AND cujo valor eh uma copia de *this
-  // Deve ser utilizada, por exemplo, no construtor por copia da classe Circuito
+  // A porta retornada deve ser liberada com delete
   virtual ptr_Port clone() const = 0;
+  // Idem, mas cria a copia (e o seu vetor id_in) na arena A, de onde nao deve ser
+  // liberada com delete (ver ArenaPortas)
+  // Deve ser utilizada, por exemplo, no construtor por copia da classe Circuito
+  virtual ptr_Port clone(ArenaPortas &A) const = 0;
 
   /// ***********************
   /// Funcoes de testagem
@@ -86,6 +142,7 @@ public:
 
   // Caracteristicas da porta
   unsigned getNumInputs() const; // ===== FEITO =====
+  TipoPorta getTipo() const { return tipo; }
 
   // Saida logica da porta
   bool3S getOutput() const; // ===== FEITO =====
@@ -166,8 +223,9 @@ public:
   // faz out_port <- UNDEF e retorna.
   // Armazena o valor bool3S com o resultado da simulacao (saida da porta)
   // no dado "out_port" da porta
-  // Se baseia nos operadores AND, OR, etc da classe bool3S
-  virtual void simular(const std::vector<bool3S> &in_port) = 0;
+  // Este metodo nao eh virtual: o calculo eh feito pelo avaliador de portas
+  // (avaliarPorta), de acordo com o tipo da porta, e vale para todas as ports
+  void simular(const std::vector<bool3S> &in_port);
 };
 
 // Operador << com comportamento polimorfico
@@ -181,9 +239,12 @@ std::ostream &operator<<(std::ostream &O, const Port &X); // ===== FEITO =====
 class Port_NOT : public Port
 {
 public:
-  Port_NOT(); // ===== FEITO ======
+  Port_NOT(std::pmr::memory_resource *MR = std::pmr::get_default_resource()); // ===== FEITO ======
+  Port_NOT(const Port_NOT &P, std::pmr::memory_resource *MR = std::pmr::get_default_resource());
   // Retorna new Port_NOT(*this)
   ptr_Port clone() const; // ===== FEITO ======
+  // Retorna uma copia de *this criada na arena A
+  ptr_Port clone(ArenaPortas &A) const;
   // Retorna "NT"
   std::string getName() const; // ===== FEITO ======
 
@@ -194,108 +255,84 @@ public:
   // (nao deve ser solicitado a digitar o numero de entradas, que eh sempre 1)
   // Se o usuario digitar um dado invalido, o metodo deve pedir que ele digite novamente
   void digitar(); // ===== FEITO ======
-
-  // Testa se a dimensao do vetor in_port eh igual ao numero de entradas da porta (1);
-  // se não for, faz out_port <- UNDEF e retorna.
-  // Armazena o valor bool3S com o resultado da simulacao (saida da porta)
-  // no dado "out_port" da porta
-  void simular(const std::vector<bool3S> &in_port); // ===== FEITO ======
 };
 
 class Port_AND : public Port
 {
 public:
-  Port_AND(); // ===== FEITO =====
+  Port_AND(std::pmr::memory_resource *MR = std::pmr::get_default_resource()); // ===== FEITO =====
+  Port_AND(const Port_AND &P, std::pmr::memory_resource *MR = std::pmr::get_default_resource());
   // Retorna new Port_AND(*this)
   ptr_Port clone() const; // ===== FEITO =====
+  // Retorna uma copia de *this criada na arena A
+  ptr_Port clone(ArenaPortas &A) const;
   // Retorna "AN"
   std::string getName() const; // ===== FEITO =====
-
-  // Testa se a dimensao do vetor in_port eh igual ao numero de entradas da porta;
-  // se não for, faz out_port <- UNDEF e retorna.
-  // Armazena o valor bool3S com o resultado da simulacao (saida da porta)
-  // no dado "out_port" da porta
-  void simular(const std::vector<bool3S> &in_port); // ===== FEITO (verificar) =====
 };
 
 class Port_NAND : public Port
 {
 public:
-  Port_NAND(); // ===== FEITO =====
+  Port_NAND(std::pmr::memory_resource *MR = std::pmr::get_default_resource()); // ===== FEITO =====
+  Port_NAND(const Port_NAND &P, std::pmr::memory_resource *MR = std::pmr::get_default_resource());
   // Retorna new Port_NAND(*this)
   ptr_Port clone() const; // ===== FEITO =====
+  // Retorna uma copia de *this criada na arena A
+  ptr_Port clone(ArenaPortas &A) const;
   // Retorna "NA"
   std::string getName() const; // ===== FEITO =====
-
-  // Testa se a dimensao do vetor in_port eh igual ao numero de entradas da porta;
-  // se não for, faz out_port <- UNDEF e retorna.
-  // Armazena o valor bool3S com o resultado da simulacao (saida da porta)
-  // no dado "out_port" da porta
-  void simular(const std::vector<bool3S> &in_port); // ===== FEITO (verificar) =====
 };
 
 class Port_OR : public Port
 {
 public:
-  Port_OR(); // ===== FEITO =====
+  Port_OR(std::pmr::memory_resource *MR = std::pmr::get_default_resource()); // ===== FEITO =====
+  Port_OR(const Port_OR &P, std::pmr::memory_resource *MR = std::pmr::get_default_resource());
   // Retorna new Port_OR(*this)
   ptr_Port clone() const; // ===== FEITO =====
+  // Retorna uma copia de *this criada na arena A
+  ptr_Port clone(ArenaPortas &A) const;
   // Retorna "OR"
   std::string getName() const; // ===== FEITO =====
-
-  // Testa se a dimensao do vetor in_port eh igual ao numero de entradas da porta;
-  // se não for, faz out_port <- UNDEF e retorna.
-  // Armazena o valor bool3S com o resultado da simulacao (saida da porta)
-  // no dado "out_port" da porta
-  void simular(const std::vector<bool3S> &in_port); // ===== FEITO =====
 };
 
 class Port_NOR : public Port
 {
 public:
-  Port_NOR(); // ===== FEITO =====
+  Port_NOR(std::pmr::memory_resource *MR = std::pmr::get_default_resource()); // ===== FEITO =====
+  Port_NOR(const Port_NOR &P, std::pmr::memory_resource *MR = std::pmr::get_default_resource());
   // Retorna new Port_NOR(*this)
   ptr_Port clone() const; // ===== FEITO =====
+  // Retorna uma copia de *this criada na arena A
+  ptr_Port clone(ArenaPortas &A) const;
   // Retorna "NO"
   std::string getName() const; // ===== FEITO =====
-
-  // Testa se a dimensao do vetor in_port eh igual ao numero de entradas da porta;
-  // se não for, faz out_port <- UNDEF e retorna.
-  // Armazena o valor bool3S com o resultado da simulacao (saida da porta)
-  // no dado "out_port" da porta
-  void simular(const std::vector<bool3S> &in_port); // ===== FEITO =====
 };
 
 class Port_XOR : public Port
 {
 public:
-  Port_XOR(); // ===== FEITO =====
+  Port_XOR(std::pmr::memory_resource *MR = std::pmr::get_default_resource()); // ===== FEITO =====
+  Port_XOR(const Port_XOR &P, std::pmr::memory_resource *MR = std::pmr::get_default_resource());
   // Retorna new Port_XOR(*this)
   ptr_Port clone() const; // ===== FEITO =====
+  // Retorna uma copia de *this criada na arena A
+  ptr_Port clone(ArenaPortas &A) const;
   // Retorna "XO"
   std::string getName() const; // ===== FEITO =====
-
-  // Testa se a dimensao do vetor in_port eh igual ao numero de entradas da porta;
-  // se não for, faz out_port <- UNDEF e retorna.
-  // Armazena o valor bool3S com o resultado da simulacao (saida da porta)
-  // no dado "out_port" da porta
-  void simular(const std::vector<bool3S> &in_port); // ===== FEITO =====
 };
 
 class Port_NXOR : public Port
 {
 public:
-  Port_NXOR(); // ===== FEITO =====
+  Port_NXOR(std::pmr::memory_resource *MR = std::pmr::get_default_resource()); // ===== FEITO =====
+  Port_NXOR(const Port_NXOR &P, std::pmr::memory_resource *MR = std::pmr::get_default_resource());
   // Retorna new Port_NXOR(*this)
   ptr_Port clone() const; // ===== FEITO =====
+  // Retorna uma copia de *this criada na arena A
+  ptr_Port clone(ArenaPortas &A) const;
   // Retorna "NX"
   std::string getName() const; // ===== FEITO =====
-
-  // Testa se a dimensao do vetor in_port eh igual ao numero de entradas da porta;
-  // se não for, faz out_port <- UNDEF e retorna.
-  // Armazena o valor bool3S com o resultado da simulacao (saida da porta)
-  // no dado "out_port" da porta
-  void simular(const std::vector<bool3S> &in_port); // ===== FEITO =====
 };
 
 #endif // _PORT_H_
\ No newline at end of file
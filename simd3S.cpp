@@ -0,0 +1,262 @@
+#include <atomic>
+#include "simd3S.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD3S_X86
+#include <immintrin.h>
+#endif
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+using namespace std;
+
+// Retorna true se a saida da porta eh a negacao da operacao basica (NT, NA, NO, NX)
+static inline bool portaNegada(TipoPorta T)
+{
+  return T == TipoPorta::NT || T == TipoPorta::NA || T == TipoPorta::NO || T == TipoPorta::NX;
+}
+
+/// ***********************
+/// Kernel escalar
+/// ***********************
+
+static void avaliarEscalar(TipoPorta T, const uint32_t *fanin, unsigned n,
+                           const Bloco3S *valores, Bloco3S &S)
+{
+  S = valores[fanin[0]];
+  switch (T)
+  {
+  case TipoPorta::AN:
+  case TipoPorta::NA:
+    for (unsigned j = 1; j < n; j++)
+    {
+      const Bloco3S &A = valores[fanin[j]];
+      for (unsigned w = 0; w < PALAVRAS_BLOCO3S; w++)
+      {
+        S.t[w] &= A.t[w];
+        S.f[w] |= A.f[w];
+      }
+    }
+    break;
+  case TipoPorta::OR:
+  case TipoPorta::NO:
+    for (unsigned j = 1; j < n; j++)
+    {
+      const Bloco3S &A = valores[fanin[j]];
+      for (unsigned w = 0; w < PALAVRAS_BLOCO3S; w++)
+      {
+        S.t[w] |= A.t[w];
+        S.f[w] &= A.f[w];
+      }
+    }
+    break;
+  case TipoPorta::XO:
+  case TipoPorta::NX:
+    for (unsigned j = 1; j < n; j++)
+    {
+      const Bloco3S &A = valores[fanin[j]];
+      for (unsigned w = 0; w < PALAVRAS_BLOCO3S; w++)
+      {
+        uint64_t t = (S.t[w] & A.f[w]) | (S.f[w] & A.t[w]);
+        uint64_t f = (S.t[w] & A.t[w]) | (S.f[w] & A.f[w]);
+        S.t[w] = t;
+        S.f[w] = f;
+      }
+    }
+    break;
+  default:
+    break;
+  }
+  if (portaNegada(T))
+  {
+    for (unsigned w = 0; w < PALAVRAS_BLOCO3S; w++)
+    {
+      uint64_t t = S.t[w];
+      S.t[w] = S.f[w];
+      S.f[w] = t;
+    }
+  }
+}
+
+#ifdef SIMD3S_X86
+
+/// ***********************
+/// Kernel AVX2: cada plano do bloco ocupa 2 registradores de 256 bits
+/// ***********************
+
+__attribute__((target("avx2"))) static void
+avaliarAVX2(TipoPorta T, const uint32_t *fanin, unsigned n, const Bloco3S *valores, Bloco3S &S)
+{
+  const Bloco3S &A0 = valores[fanin[0]];
+  __m256i t0 = _mm256_load_si256((const __m256i *)(A0.t));
+  __m256i t1 = _mm256_load_si256((const __m256i *)(A0.t + 4));
+  __m256i f0 = _mm256_load_si256((const __m256i *)(A0.f));
+  __m256i f1 = _mm256_load_si256((const __m256i *)(A0.f + 4));
+
+  switch (T)
+  {
+  case TipoPorta::AN:
+  case TipoPorta::NA:
+    for (unsigned j = 1; j < n; j++)
+    {
+      const Bloco3S &A = valores[fanin[j]];
+      t0 = _mm256_and_si256(t0, _mm256_load_si256((const __m256i *)(A.t)));
+      t1 = _mm256_and_si256(t1, _mm256_load_si256((const __m256i *)(A.t + 4)));
+      f0 = _mm256_or_si256(f0, _mm256_load_si256((const __m256i *)(A.f)));
+      f1 = _mm256_or_si256(f1, _mm256_load_si256((const __m256i *)(A.f + 4)));
+    }
+    break;
+  case TipoPorta::OR:
+  case TipoPorta::NO:
+    for (unsigned j = 1; j < n; j++)
+    {
+      const Bloco3S &A = valores[fanin[j]];
+      t0 = _mm256_or_si256(t0, _mm256_load_si256((const __m256i *)(A.t)));
+      t1 = _mm256_or_si256(t1, _mm256_load_si256((const __m256i *)(A.t + 4)));
+      f0 = _mm256_and_si256(f0, _mm256_load_si256((const __m256i *)(A.f)));
+      f1 = _mm256_and_si256(f1, _mm256_load_si256((const __m256i *)(A.f + 4)));
+    }
+    break;
+  case TipoPorta::XO:
+  case TipoPorta::NX:
+    for (unsigned j = 1; j < n; j++)
+    {
+      const Bloco3S &A = valores[fanin[j]];
+      __m256i at0 = _mm256_load_si256((const __m256i *)(A.t));
+      __m256i at1 = _mm256_load_si256((const __m256i *)(A.t + 4));
+      __m256i af0 = _mm256_load_si256((const __m256i *)(A.f));
+      __m256i af1 = _mm256_load_si256((const __m256i *)(A.f + 4));
+      __m256i nt0 = _mm256_or_si256(_mm256_and_si256(t0, af0), _mm256_and_si256(f0, at0));
+      __m256i nt1 = _mm256_or_si256(_mm256_and_si256(t1, af1), _mm256_and_si256(f1, at1));
+      f0 = _mm256_or_si256(_mm256_and_si256(t0, at0), _mm256_and_si256(f0, af0));
+      f1 = _mm256_or_si256(_mm256_and_si256(t1, at1), _mm256_and_si256(f1, af1));
+      t0 = nt0;
+      t1 = nt1;
+    }
+    break;
+  default:
+    break;
+  }
+
+  // Nas portas negadas, basta trocar os planos ao guardar o resultado
+  bool neg = portaNegada(T);
+  _mm256_store_si256((__m256i *)(neg ? S.f : S.t), t0);
+  _mm256_store_si256((__m256i *)(neg ? S.f + 4 : S.t + 4), t1);
+  _mm256_store_si256((__m256i *)(neg ? S.t : S.f), f0);
+  _mm256_store_si256((__m256i *)(neg ? S.t + 4 : S.f + 4), f1);
+}
+
+/// ***********************
+/// Kernel AVX-512: cada plano do bloco ocupa 1 registrador de 512 bits
+/// ***********************
+
+__attribute__((target("avx512f"))) static void
+avaliarAVX512(TipoPorta T, const uint32_t *fanin, unsigned n, const Bloco3S *valores, Bloco3S &S)
+{
+  const Bloco3S &A0 = valores[fanin[0]];
+  __m512i t = _mm512_load_si512(A0.t);
+  __m512i f = _mm512_load_si512(A0.f);
+
+  switch (T)
+  {
+  case TipoPorta::AN:
+  case TipoPorta::NA:
+    for (unsigned j = 1; j < n; j++)
+    {
+      const Bloco3S &A = valores[fanin[j]];
+      t = _mm512_and_si512(t, _mm512_load_si512(A.t));
+      f = _mm512_or_si512(f, _mm512_load_si512(A.f));
+    }
+    break;
+  case TipoPorta::OR:
+  case TipoPorta::NO:
+    for (unsigned j = 1; j < n; j++)
+    {
+      const Bloco3S &A = valores[fanin[j]];
+      t = _mm512_or_si512(t, _mm512_load_si512(A.t));
+      f = _mm512_and_si512(f, _mm512_load_si512(A.f));
+    }
+    break;
+  case TipoPorta::XO:
+  case TipoPorta::NX:
+    for (unsigned j = 1; j < n; j++)
+    {
+      const Bloco3S &A = valores[fanin[j]];
+      __m512i at = _mm512_load_si512(A.t);
+      __m512i af = _mm512_load_si512(A.f);
+      __m512i nt = _mm512_or_si512(_mm512_and_si512(t, af), _mm512_and_si512(f, at));
+      f = _mm512_or_si512(_mm512_and_si512(t, at), _mm512_and_si512(f, af));
+      t = nt;
+    }
+    break;
+  default:
+    break;
+  }
+
+  bool neg = portaNegada(T);
+  _mm512_store_si512(neg ? S.f : S.t, t);
+  _mm512_store_si512(neg ? S.t : S.f, f);
+}
+
+#endif // SIMD3S_X86
+
+/// ***********************
+/// Escolha do kernel
+/// ***********************
+
+NivelSIMD detectarSIMD()
+{
+#ifdef SIMD3S_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return NivelSIMD::AVX512;
+  if (__builtin_cpu_supports("avx2"))
+    return NivelSIMD::AVX2;
+#endif
+  return NivelSIMD::ESCALAR;
+}
+
+// Retorna o kernel de um nivel (que deve ser suportado)
+static AvaliadorBloco kernelSIMD(NivelSIMD N)
+{
+#ifdef SIMD3S_X86
+  if (N == NivelSIMD::AVX512)
+    return avaliarAVX512;
+  if (N == NivelSIMD::AVX2)
+    return avaliarAVX2;
+#endif
+  return avaliarEscalar;
+}
+
+// O nivel em uso e o seu kernel
+static atomic<NivelSIMD> nivel_atual(detectarSIMD());
+static atomic<AvaliadorBloco> kernel_atual(kernelSIMD(nivel_atual.load()));
+
+NivelSIMD getNivelSIMD()
+{
+  return nivel_atual.load();
+}
+
+bool setNivelSIMD(NivelSIMD N)
+{
+  if (int(N) > int(detectarSIMD()))
+    return false;
+  nivel_atual.store(N);
+  kernel_atual.store(kernelSIMD(N));
+  return true;
+}
+
+const char *nomeNivelSIMD(NivelSIMD N)
+{
+  if (N == NivelSIMD::AVX512)
+    return "avx512";
+  if (N == NivelSIMD::AVX2)
+    return "avx2";
+  return "escalar";
+}
+
+AvaliadorBloco getAvaliadorBloco()
+{
+  return kernel_atual.load();
+}
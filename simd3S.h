@@ -0,0 +1,49 @@
+#ifndef _SIMD3S_H_
+#define _SIMD3S_H_
+
+#include <cstdint>
+#include "palavra3S.h"
+#include "netlist.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// KERNELS VETORIAIS PARA A SIMULACAO POR BLOCOS (Bloco3S, 512 vetores)
+/// Ha uma versao escalar (palavras de 64 bits), uma AVX2 (registradores de
+/// 256 bits) e uma AVX-512 (registradores de 512 bits) do kernel que avalia uma
+/// porta. A versao usada eh escolhida em tempo de execucao, de acordo com o
+/// processador; as versoes vetoriais soh existem quando compiladas com GCC ou
+/// Clang para x86, nos demais casos usa-se sempre a versao escalar.
+/// ###########################################################################
+
+// Os conjuntos de instrucoes para os quais existem kernels
+enum class NivelSIMD
+{
+  ESCALAR,
+  AVX2,
+  AVX512
+};
+
+// Retorna o melhor nivel suportado pelo processador (e pela compilacao)
+NivelSIMD detectarSIMD();
+
+// Retorna o nivel em uso (inicialmente, o retornado por detectarSIMD)
+NivelSIMD getNivelSIMD();
+
+// Passa a usar o nivel N (p.ex. para comparar o desempenho dos kernels)
+// Retorna false, sem alterar o nivel em uso, se N nao for suportado
+bool setNivelSIMD(NivelSIMD N);
+
+// Retorna o nome do nivel: "escalar", "avx2" ou "avx512"
+const char *nomeNivelSIMD(NivelSIMD N);
+
+// Um kernel: calcula em S a saida de uma porta do tipo T para os 512 vetores de
+// um bloco, sendo fanin os n sinais (posicoes no vetor valores) que alimentam a porta
+typedef void (*AvaliadorBloco)(TipoPorta T, const uint32_t *fanin, unsigned n,
+                               const Bloco3S *valores, Bloco3S &S);
+
+// Retorna o kernel do nivel em uso
+AvaliadorBloco getAvaliadorBloco();
+
+#endif // _SIMD3S_H_
@@ -0,0 +1,667 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "tabela.h"
+#include "netlist.h"
+#include "binario.h"
+#include "instrumentacao.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+using namespace std;
+
+uint64_t numLinhasTabela(unsigned NI)
+{
+  uint64_t N = 1;
+  for (unsigned i = 0; i < NI; i++)
+    N *= 3;
+  return N;
+}
+
+void preencherLinhas(unsigned NI, uint64_t Linha0, unsigned N, Palavra3S *in_circ)
+{
+  // Os digitos (na base 3) da linha atual, do mais significativo ao menos
+  vector<unsigned> digito(NI);
+  for (int i = int(NI) - 1; i >= 0; i--)
+  {
+    digito[i] = Linha0 % 3;
+    Linha0 /= 3;
+  }
+
+  for (unsigned i = 0; i < NI; i++)
+    in_circ[i] = palavraUNDEF();
+
+  for (unsigned b = 0; b < N; b++)
+  {
+    uint64_t mask = uint64_t(1) << b;
+    for (unsigned i = 0; i < NI; i++)
+    {
+      if (digito[i] == 2)
+        in_circ[i].t |= mask;
+      else if (digito[i] == 1)
+        in_circ[i].f |= mask;
+    }
+    // Incrementa a ultima entrada que nao for TRUE; as seguintes voltam a UNDEF
+    int i = int(NI) - 1;
+    while (i >= 0 && digito[i] == 2)
+    {
+      digito[i] = 0;
+      i--;
+    }
+    if (i >= 0)
+      digito[i]++;
+  }
+}
+
+void preencherLinhas(unsigned NI, uint64_t Linha0, unsigned N, Bloco3S *in_circ)
+{
+  vector<Palavra3S> palavra(NI);
+  for (unsigned i = 0; i < NI; i++)
+    in_circ[i] = blocoUNDEF();
+  for (unsigned w = 0; w < PALAVRAS_BLOCO3S && w * BITS_PALAVRA3S < N; w++)
+  {
+    unsigned nb = N - w * BITS_PALAVRA3S;
+    if (nb > BITS_PALAVRA3S)
+      nb = BITS_PALAVRA3S;
+    preencherLinhas(NI, Linha0 + w * BITS_PALAVRA3S, nb, palavra.data());
+    for (unsigned i = 0; i < NI; i++)
+      setPalavra3S(in_circ[i], w, palavra[i]);
+  }
+}
+
+// Simula as linhas de L a L+NL-1 (NL <= LINHAS_TRECHO_TABELA) e acrescenta em Buffer
+// o que for produzido por Formatar
+static void simularTrecho(const Netlist &N, uint64_t L, uint64_t NL,
+                          vector<Bloco3S> &in_circ, vector<Bloco3S> &valores,
+                          const FormatarTabela &Formatar, string &Buffer)
+{
+  for (uint64_t b = 0; b < NL; b += BITS_BLOCO3S)
+  {
+    unsigned nb = (NL - b < BITS_BLOCO3S ? NL - b : BITS_BLOCO3S);
+    preencherLinhas(N.getNumInputs(), L + b, nb, in_circ.data());
+    N.simular(in_circ.data(), valores.data());
+    INSTR_FASE(SAIDA);
+    Formatar(L + b, nb, in_circ.data(), valores.data(), Buffer);
+  }
+}
+
+bool simularTabela(const Netlist &N, unsigned NThreads,
+                   const FormatarTabela &Formatar, const EscreverTabela &Escrever)
+{
+  uint64_t Nlinhas = numLinhasTabela(N.getNumInputs());
+  uint64_t Ntrechos = (Nlinhas + LINHAS_TRECHO_TABELA - 1) / LINHAS_TRECHO_TABELA;
+
+  if (NThreads == 0)
+    NThreads = thread::hardware_concurrency();
+  if (NThreads == 0)
+    NThreads = 1;
+  if (NThreads > Ntrechos)
+    NThreads = Ntrechos;
+
+  // Tamanho do trecho T
+  auto linhasTrecho = [&](uint64_t T) -> uint64_t
+  {
+    uint64_t L = T * LINHAS_TRECHO_TABELA;
+    return (Nlinhas - L < LINHAS_TRECHO_TABELA ? Nlinhas - L : LINHAS_TRECHO_TABELA);
+  };
+
+  if (NThreads <= 1)
+  {
+    vector<Bloco3S> in_circ(N.getNumInputs()), valores(N.getNumSinais());
+    string Buffer;
+    for (uint64_t T = 0; T < Ntrechos; T++)
+    {
+      Buffer.clear();
+      simularTrecho(N, T * LINHAS_TRECHO_TABELA, linhasTrecho(T), in_circ, valores, Formatar, Buffer);
+      INSTR_FASE(SAIDA);
+      if (!Escrever(Buffer))
+        return false;
+    }
+    return true;
+  }
+
+  // Os buffers dos trechos ainda nao escritos formam uma fila circular com Nbuffers
+  // posicoes: o trecho T usa a posicao T % Nbuffers, e soh pode ser simulado quando
+  // todos os trechos ateh T-Nbuffers jah tiverem sido escritos
+  const uint64_t Nbuffers = 4 * NThreads;
+  vector<string> buffer(Nbuffers);
+  vector<bool> pronto(Nbuffers, false);
+  uint64_t escritos = 0;
+  atomic<uint64_t> proximo(0);
+  mutex m;
+  condition_variable cv_pronto, cv_livre;
+  // parar: a escrita falhou ou alguma thread deu erro (a primeira excecao fica em erro)
+  bool parar = false;
+  exception_ptr erro;
+
+  auto interromper = [&]()
+  {
+    {
+      lock_guard<mutex> trava(m);
+      parar = true;
+    }
+    cv_pronto.notify_all();
+    cv_livre.notify_all();
+  };
+
+  auto trabalhar = [&]()
+  {
+    try
+    {
+      vector<Bloco3S> in_circ(N.getNumInputs()), valores(N.getNumSinais());
+      string local;
+      uint64_t T;
+      while ((T = proximo++) < Ntrechos)
+      {
+        {
+          unique_lock<mutex> trava(m);
+          cv_livre.wait(trava, [&]() { return parar || T < escritos + Nbuffers; });
+          if (parar)
+            return;
+        }
+        local.clear();
+        simularTrecho(N, T * LINHAS_TRECHO_TABELA, linhasTrecho(T), in_circ, valores, Formatar, local);
+        {
+          lock_guard<mutex> trava(m);
+          buffer[T % Nbuffers].swap(local);
+          pronto[T % Nbuffers] = true;
+        }
+        cv_pronto.notify_all();
+      }
+    }
+    catch (...)
+    {
+      {
+        lock_guard<mutex> trava(m);
+        if (!erro)
+          erro = current_exception();
+      }
+      interromper();
+    }
+  };
+
+  // As threads sao sempre esperadas ao sair do bloco abaixo, inclusive por uma
+  // excecao (de Escrever, p.ex.): antes, elas sao avisadas para parar
+  struct EsperarThreads
+  {
+    vector<thread> threads;
+    function<void()> interromper;
+    ~EsperarThreads()
+    {
+      interromper();
+      for (thread &t : threads)
+        t.join();
+    }
+  };
+
+  // Esta thread junta os trechos, na ordem, ateh o fim ou ateh uma interrupcao
+  bool ok = true;
+  {
+    EsperarThreads esperar{{}, interromper};
+    for (unsigned t = 0; t < NThreads; t++)
+      esperar.threads.emplace_back(trabalhar);
+
+    string atual;
+    for (uint64_t T = 0; T < Ntrechos && ok; T++)
+    {
+      {
+        unique_lock<mutex> trava(m);
+        cv_pronto.wait(trava, [&]() { return parar || bool(pronto[T % Nbuffers]); });
+        if (parar)
+          break;
+        atual.swap(buffer[T % Nbuffers]);
+        pronto[T % Nbuffers] = false;
+        escritos++;
+      }
+      cv_livre.notify_all();
+      INSTR_FASE(SAIDA);
+      ok = Escrever(atual);
+    }
+  }
+
+  // O erro de alguma das threads eh repassado a quem chamou
+  if (erro)
+    rethrow_exception(erro);
+  return ok;
+}
+
+bool gerarTabela(const Circuito &C, std::ostream &O, unsigned NThreads)
+{
+  if (!C.valid() || C.getNumInputs() > MAX_ENTRADAS_TABELA)
+    return false;
+
+  const Netlist &N = C.getNetlist();
+  unsigned NI = N.getNumInputs();
+  unsigned NO = N.getNumOutputs();
+
+  // Cada linha da tabela eh formatada no buffer da thread que a simulou
+  auto formatar = [&](uint64_t, unsigned NL, const Bloco3S *in_circ,
+                      const Bloco3S *valores, string &Buffer)
+  {
+    for (unsigned b = 0; b < NL; b++)
+    {
+      // Impressao das entradas
+      for (unsigned i = 0; i < NI; i++)
+      {
+        Buffer += toChar(getBool3S(in_circ[i], b));
+        if (i < NI - 1)
+          Buffer += ' ';
+        else
+        {
+          Buffer += '\t';
+          if (NI <= 2)
+            Buffer += '\t';
+        }
+      }
+
+      // Impressao das saidas
+      for (unsigned j = 0; j < NO; j++)
+      {
+        Buffer += toChar(getBool3S(valores[N.getSaida(j)], b));
+        if (j < NO - 1)
+          Buffer += ' ';
+        else
+          Buffer += '\n';
+      }
+    }
+  };
+  auto escrever = [&](const string &Buffer)
+  {
+    O.write(Buffer.data(), Buffer.size());
+    return O.good();
+  };
+
+  O << "ENTRADAS" << '\t' << "SAIDAS" << endl;
+  return simularTabela(N, NThreads, formatar, escrever);
+}
+
+/// ***********************
+/// Tabela verdade em formato binario
+/// ***********************
+
+// Faz In (dimensao NI) <- as entradas da linha L (os digitos de L na base 3)
+static void entradasLinha(unsigned NI, uint64_t L, vector<bool3S> &In)
+{
+  In.resize(NI);
+  for (int i = int(NI) - 1; i >= 0; i--)
+  {
+    In[i] = bool3S(L % 3);
+    L /= 3;
+  }
+}
+
+// Passa In para as entradas da linha seguinte
+static void proximaLinha(vector<bool3S> &In)
+{
+  int i = int(In.size()) - 1;
+  while (i >= 0 && In[i] == bool3S::TRUE)
+  {
+    In[i]++;
+    i--;
+  }
+  if (i >= 0)
+    In[i]++;
+}
+
+bool salvarTabelaBinaria(const Circuito &C, const std::string &arq, unsigned NThreads)
+{
+  static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+  if (!C.valid() || C.getNumInputs() > MAX_ENTRADAS_TABELA)
+    return false;
+
+  const Netlist &N = C.getNetlist();
+  unsigned NO = N.getNumOutputs();
+  unsigned BL = bytesLinhaTabela(NO);
+  CabecalhoTabela cab;
+
+  memcpy(cab.magica, MAGICA_TABELA, 8);
+  cab.ordem = ORDEM_BINARIO;
+  cab.versao = VERSAO_TABELA;
+  cab.Nin = N.getNumInputs();
+  cab.Nout = NO;
+  cab.bytesLinha = BL;
+  cab.reservado = 0;
+  cab.Nlinhas = numLinhasTabela(N.getNumInputs());
+  cab.checksum = HASH_FNV_INICIAL;
+
+  ofstream arquivo(arq, ios::binary);
+  if (!arquivo.is_open())
+    return false;
+  // O cabecalho eh gravado de novo no final, com o checksum
+  arquivo.write(reinterpret_cast<const char *>(&cab), sizeof(cab));
+
+  // Cada bloco eh compactado no buffer da thread que o simulou: o valor de cada
+  // saida vem direto dos bits dos planos t (TRUE=2) e f (FALSE=1)
+  auto formatar = [&](uint64_t, unsigned NL, const Bloco3S *, const Bloco3S *valores,
+                      string &Buffer)
+  {
+    size_t pos = Buffer.size();
+    Buffer.resize(pos + size_t(NL) * BL, '\0');
+    char *p = &Buffer[pos];
+    for (unsigned j = 0; j < NO; j++)
+    {
+      const Bloco3S &S = valores[N.getSaida(j)];
+      unsigned desl = 2 * (j % 4);
+      char *q = p + j / 4;
+      for (unsigned b = 0; b < NL; b++, q += BL)
+      {
+        unsigned w = b / BITS_PALAVRA3S, k = b % BITS_PALAVRA3S;
+        unsigned x = (((S.t[w] >> k) & 1) << 1) | ((S.f[w] >> k) & 1);
+        *q |= char(x << desl);
+      }
+    }
+  };
+  // hashFNV processa o conteudo em palavras de 8 bytes: para que o hash calculado por
+  // partes seja igual ao do conteudo inteiro, cada parte deve ter um multiplo de 8 bytes,
+  // e o que sobra de um trecho (resto) fica para o seguinte
+  string resto;
+  auto escrever = [&](const string &Buffer)
+  {
+    if (!arquivo.write(Buffer.data(), Buffer.size()))
+      return false;
+    size_t i = 0;
+    if (!resto.empty())
+    {
+      i = min(Buffer.size(), 8 - resto.size());
+      resto.append(Buffer, 0, i);
+      if (resto.size() < 8)
+        return true;
+      cab.checksum = hashFNV(resto.data(), 8, cab.checksum);
+      resto.clear();
+    }
+    size_t n = (Buffer.size() - i) / 8 * 8;
+    cab.checksum = hashFNV(Buffer.data() + i, n, cab.checksum);
+    resto.assign(Buffer, i + n, string::npos);
+    return true;
+  };
+
+  if (!simularTabela(N, NThreads, formatar, escrever))
+    return false;
+
+  size_t pad = (8 - (cab.Nlinhas * BL) % 8) % 8;
+  arquivo.write(zeros, pad);
+  resto.append(zeros, pad);
+  cab.checksum = hashFNV(resto.data(), resto.size(), cab.checksum);
+  arquivo.seekp(0);
+  arquivo.write(reinterpret_cast<const char *>(&cab), sizeof(cab));
+  return arquivo.good();
+}
+
+///
+/// CLASSE TABELA BINARIA
+///
+
+TabelaBinaria::TabelaBinaria() : linhas(nullptr)
+{
+  memset(&cab, 0, sizeof(cab));
+}
+
+void TabelaBinaria::fechar()
+{
+  arquivo.fechar();
+  memset(&cab, 0, sizeof(cab));
+  linhas = nullptr;
+}
+
+bool TabelaBinaria::abrir(const std::string &arq)
+{
+  fechar();
+  if (!arquivo.abrir(arq) || arquivo.getTamanho() < sizeof(cab))
+    return false;
+  memcpy(&cab, arquivo.getDados(), sizeof(cab));
+  if (memcmp(cab.magica, MAGICA_TABELA, 8) != 0)
+  {
+    cerr << "Erro: Arquivo nao estah no formato binario de tabela verdade\n";
+    fechar();
+    return false;
+  }
+  if (cab.ordem != ORDEM_BINARIO || cab.versao != VERSAO_TABELA)
+  {
+    cerr << "Erro: Versao ou ordem de bytes da tabela binaria nao suportada\n";
+    fechar();
+    return false;
+  }
+  if (cab.Nin > MAX_ENTRADAS_TABELA || cab.Nlinhas != numLinhasTabela(cab.Nin) ||
+      cab.bytesLinha != bytesLinhaTabela(cab.Nout) ||
+      cab.Nlinhas > (arquivo.getTamanho() - sizeof(cab)) / max(cab.bytesLinha, 1u))
+  {
+    cerr << "Erro: Tamanho da tabela binaria incompativel com o cabecalho\n";
+    fechar();
+    return false;
+  }
+  size_t tam = cab.Nlinhas * cab.bytesLinha;
+  tam += (8 - tam % 8) % 8;
+  if (sizeof(cab) + tam != arquivo.getTamanho())
+  {
+    cerr << "Erro: Tamanho da tabela binaria incompativel com o cabecalho\n";
+    fechar();
+    return false;
+  }
+  if (hashFNV(arquivo.getDados() + sizeof(cab), tam) != cab.checksum)
+  {
+    cerr << "Erro: Checksum da tabela binaria nao confere\n";
+    fechar();
+    return false;
+  }
+  linhas = reinterpret_cast<const uint8_t *>(arquivo.getDados() + sizeof(cab));
+  return true;
+}
+
+// Acrescenta em Buffer uma linha da tabela verdade, no mesmo formato de gerarTabela:
+// as entradas In, seguidas das NO saidas dos Bytes da linha na tabela binaria
+static void formatarLinha(const vector<bool3S> &In, const uint8_t *Bytes, unsigned NO,
+                          string &Buffer)
+{
+  unsigned NI = In.size();
+  for (unsigned i = 0; i < NI; i++)
+  {
+    Buffer += toChar(In[i]);
+    Buffer += (i < NI - 1 ? " " : NI <= 2 ? "\t\t" : "\t");
+  }
+  for (unsigned j = 0; j < NO; j++)
+  {
+    Buffer += toChar(bool3S((Bytes[j / 4] >> (2 * (j % 4))) & 3));
+    Buffer += (j < NO - 1 ? ' ' : '\n');
+  }
+}
+
+void TabelaBinaria::imprimir(std::ostream &O) const
+{
+  if (!aberta())
+    return;
+  vector<bool3S> in_circ(cab.Nin, bool3S::UNDEF);
+  string Buffer;
+
+  O << "ENTRADAS" << '\t' << "SAIDAS" << endl;
+  for (uint64_t L = 0; L < cab.Nlinhas; L++)
+  {
+    formatarLinha(in_circ, getLinha(L), cab.Nout, Buffer);
+    proximaLinha(in_circ);
+    if (Buffer.size() >= 65536)
+    {
+      O.write(Buffer.data(), Buffer.size());
+      Buffer.clear();
+    }
+  }
+  O.write(Buffer.data(), Buffer.size());
+}
+
+bool compararTabelas(const TabelaBinaria &T1, const TabelaBinaria &T2, uint64_t &Ndif,
+                     std::ostream &O, uint64_t MaxImpressas)
+{
+  Ndif = 0;
+  if (!T1.aberta() || !T2.aberta() || T1.getNumInputs() != T2.getNumInputs() ||
+      T1.getNumOutputs() != T2.getNumOutputs())
+  {
+    cerr << "Erro: Tabelas com numeros de entradas ou de saidas diferentes\n";
+    return false;
+  }
+
+  // Trechos de linhas iguais (a maioria, em geral) sao descartados com um soh memcmp
+  const uint64_t LINHAS_TRECHO = 4096;
+  uint64_t Nlinhas = T1.getNumLinhas();
+  unsigned BL = T1.getBytesLinha(), NO = T1.getNumOutputs();
+  vector<bool3S> in_circ;
+  string Buffer;
+
+  for (uint64_t L0 = 0; L0 < Nlinhas; L0 += LINHAS_TRECHO)
+  {
+    uint64_t L1 = min(Nlinhas, L0 + LINHAS_TRECHO);
+    if (memcmp(T1.getLinha(L0), T2.getLinha(L0), (L1 - L0) * BL) == 0)
+      continue;
+    for (uint64_t L = L0; L < L1; L++)
+    {
+      if (memcmp(T1.getLinha(L), T2.getLinha(L), BL) == 0)
+        continue;
+      if (Ndif < MaxImpressas)
+      {
+        entradasLinha(T1.getNumInputs(), L, in_circ);
+        O << "Linha " << L << ":\t";
+        Buffer.clear();
+        formatarLinha(in_circ, T1.getLinha(L), NO, Buffer);
+        Buffer.back() = '\t';
+        Buffer += "| ";
+        for (unsigned j = 0; j < NO; j++)
+        {
+          Buffer += toChar(T2.getSaida(L, j));
+          Buffer += (j < NO - 1 ? ' ' : '\n');
+        }
+        O << Buffer;
+      }
+      Ndif++;
+    }
+  }
+  O << Ndif << " linha(s) diferente(s) de " << Nlinhas << endl;
+  return true;
+}
+
+/// ***********************
+/// Enumeracao em codigo de Gray ternario
+/// ***********************
+
+EnumeradorGray::EnumeradorGray(unsigned NI) : entradas(NI, bool3S::UNDEF), direcao(NI, 1),
+                                              foco(NI + 1), peso(NI), linha(0)
+{
+  for (unsigned j = 0; j <= NI; j++)
+    foco[j] = j;
+  for (unsigned j = 0; j < NI; j++)
+    peso[j] = (j == 0 ? 1 : 3 * peso[j - 1]);
+}
+
+bool EnumeradorGray::proximo(unsigned &I)
+{
+  unsigned NI = entradas.size();
+  unsigned j = foco[0];
+  foco[0] = 0;
+  if (j == NI)
+    return false;
+
+  // O digito j anda um passo no seu sentido atual
+  I = NI - 1 - j;
+  int d = int(entradas[I]) + direcao[j];
+  entradas[I] = bool3S(d);
+  if (direcao[j] > 0)
+    linha += peso[j];
+  else
+    linha -= peso[j];
+
+  // Chegou a um extremo: inverte o sentido e passa o foco adiante
+  if (d == 0 || d == 2)
+  {
+    direcao[j] = -direcao[j];
+    foco[j] = foco[j + 1];
+    foco[j + 1] = j + 1;
+  }
+  return true;
+}
+
+// Imprime uma linha da tabela verdade, no mesmo formato de gerarTabela
+static void imprimirLinha(std::ostream &O, const vector<bool3S> &in_circ,
+                          const bool3S *out_circ, unsigned NO)
+{
+  INSTR_FASE(SAIDA);
+  unsigned NI = in_circ.size();
+  for (unsigned i = 0; i < NI; i++)
+  {
+    O << in_circ[i];
+    if (i < NI - 1)
+      O << ' ';
+    else
+    {
+      O << '\t';
+      if (NI <= 2)
+        O << '\t';
+    }
+  }
+  for (unsigned j = 0; j < NO; j++)
+  {
+    O << out_circ[j];
+    if (j < NO - 1)
+      O << ' ';
+    else
+      O << '\n';
+  }
+}
+
+bool gerarTabelaGray(const Circuito &C, std::ostream &O, bool OrdemCanonica)
+{
+  if (!C.valid() || C.getNumInputs() > MAX_ENTRADAS_TABELA)
+    return false;
+
+  unsigned NI = C.getNumInputs();
+  unsigned NO = C.getNumOutputs();
+  if (OrdemCanonica && numLinhasTabela(NI) > MAX_MEMORIA_TABELA_GRAY / NO)
+    return false;
+  EnumeradorGray G(NI);
+  ContextoSimulacao Ctx;
+  vector<int> alterada(1);
+  vector<bool3S> out_circ(NO);
+  // As saidas de todas as linhas, na ordem canonica (soh se OrdemCanonica)
+  vector<bool3S> tabela;
+  unsigned I;
+
+  if (OrdemCanonica)
+    tabela.resize(numLinhasTabela(NI) * NO);
+
+  if (!OrdemCanonica)
+    O << "ENTRADAS" << '\t' << "SAIDAS" << endl;
+
+  C.simular(G.getEntradas(), Ctx);
+  do
+  {
+    for (unsigned j = 0; j < NO; j++)
+      out_circ[j] = Ctx.getOutput(j + 1);
+    if (OrdemCanonica)
+      copy(out_circ.begin(), out_circ.end(), tabela.begin() + G.getLinha() * NO);
+    else
+      imprimirLinha(O, G.getEntradas(), out_circ.data(), NO);
+
+    if (!G.proximo(I))
+      break;
+    alterada[0] = -int(I) - 1;
+    C.resimular(G.getEntradas(), alterada, Ctx);
+  } while (true);
+
+  if (OrdemCanonica)
+  {
+    // As entradas da linha sao os digitos (na base 3) do numero da linha
+    vector<bool3S> in_circ(NI, bool3S::UNDEF);
+    O << "ENTRADAS" << '\t' << "SAIDAS" << endl;
+    for (uint64_t L = 0; L < tabela.size() / NO; L++)
+    {
+      imprimirLinha(O, in_circ, tabela.data() + L * NO, NO);
+      proximaLinha(in_circ);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,220 @@
+#ifndef _TABELA_H_
+#define _TABELA_H_
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include "bool3S.h"
+#include "palavra3S.h"
+#include "circuito.h"
+#include "netlist.h"
+#include "arquivo.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// A TABELA VERDADE DE UM CIRCUITO
+/// As linhas da tabela verdade sao numeradas de 0 a 3^NumInputs-1, na ordem em
+/// que sao geradas incrementando as entradas (UNDEF -> FALSE -> TRUE) com a
+/// ultima entrada variando mais rapido: a entrada i da linha L eh o i-esimo
+/// digito de L na base 3, a partir do mais significativo (0=UNDEF, 1=FALSE, 2=TRUE)
+/// ###########################################################################
+
+// Maior numero de entradas para o qual o numero de linhas cabe em 64 bits
+const unsigned MAX_ENTRADAS_TABELA = 40;
+
+// Retorna o numero de linhas da tabela verdade de um circuito com NI entradas (3^NI)
+uint64_t numLinhasTabela(unsigned NI);
+
+// Preenche in_circ (dimensao NI) com as N linhas (N <= 64) da tabela verdade a partir
+// da linha Linha0: o bit B de in_circ[i] recebe o valor da entrada i na linha Linha0+B
+void preencherLinhas(unsigned NI, uint64_t Linha0, unsigned N, Palavra3S *in_circ);
+
+// Idem, para N linhas (N <= 512) em blocos: o bit B de in_circ[i] recebe o valor
+// da entrada i na linha Linha0+B
+void preencherLinhas(unsigned NI, uint64_t Linha0, unsigned N, Bloco3S *in_circ);
+
+/// ***********************
+/// Simulacao de toda a tabela verdade, em paralelo
+/// ***********************
+
+// Numero de linhas de cada trecho da tabela distribuido para uma thread
+const unsigned LINHAS_TRECHO_TABELA = 16 * BITS_BLOCO3S;
+
+// Funcao chamada para cada bloco de NL linhas (NL <= 512) simulado a partir da
+// linha L: recebe as entradas (in_circ, dimensao NumInputs) e os valores de todos
+// os sinais (valores, dimensao NumSinais) em blocos, e deve acrescentar em Buffer
+// o que quiser produzir para essas linhas. Eh chamada em paralelo, por varias threads,
+// cada uma com o seu proprio Buffer.
+typedef std::function<void(uint64_t L, unsigned NL, const Bloco3S *in_circ,
+                           const Bloco3S *valores, std::string &Buffer)>
+    FormatarTabela;
+
+// Funcao que recebe os Buffers produzidos para cada trecho da tabela, sempre na
+// ordem das linhas e sempre na thread que chamou simularTabela
+// Retorna false se a escrita falhou: a simulacao para, sem simular o restante
+typedef std::function<bool(const std::string &Buffer)> EscreverTabela;
+
+// Simula a netlist para todas as linhas da tabela verdade (NumInputs <= MAX_ENTRADAS_TABELA)
+// A tabela eh dividida em trechos de LINHAS_TRECHO_TABELA linhas, distribuidos entre
+// NThreads threads (0: uma por nucleo do processador). Cada thread simula os seus trechos
+// com os seus proprios vetores de valores (a netlist eh compartilhada, soh para leitura)
+// e chama Formatar para cada bloco; os buffers de cada trecho sao passados a Escrever
+// na ordem das linhas. Soh ficam em memoria os buffers de alguns trechos por thread.
+// Retorna false se Escrever falhou. Uma excecao de Formatar ou de Escrever interrompe
+// as threads, que sao esperadas antes de ela ser repassada a quem chamou
+bool simularTabela(const Netlist &N, unsigned NThreads,
+                   const FormatarTabela &Formatar, const EscreverTabela &Escrever);
+
+// Simula o circuito para todas as entradas e imprime a tabela verdade em O
+// As linhas sao simuladas de 512 em 512 (ver Netlist::simular para Bloco3S),
+// usando NThreads threads (0: uma por nucleo do processador; ver simularTabela)
+// Retorna false (e nao imprime nada) se o circuito for invalido; tambem retorna false
+// se a escrita em O falhar (a simulacao para no primeiro erro)
+bool gerarTabela(const Circuito &C, std::ostream &O = std::cout, unsigned NThreads = 0);
+
+/// ###########################################################################
+/// FORMATO BINARIO DA TABELA VERDADE (extensao sugerida: .tb3s)
+/// Guarda soh as saidas, compactadas, para que tabelas grandes sejam baratas de
+/// gravar e de comparar (p.ex. entre duas versoes do mesmo circuito):
+/// - cabecalho (CabecalhoTabela, 48 bytes)
+/// - as linhas da tabela, na ordem da secao anterior: as entradas nao sao gravadas,
+///   pois sao dadas pelo numero da linha. Cada linha ocupa BytesLinha = (NumOutputs+3)/4
+///   bytes: o valor da saida j fica nos bits 2*(j%4) e 2*(j%4)+1 do byte j/4,
+///   codificado como em bool3S (0=UNDEF, 1=FALSE, 2=TRUE)
+/// - zeros ateh completar um multiplo de 8 bytes
+/// Assim como no formato binario de circuito (ver binario.h), os inteiros ficam na
+/// ordem de bytes do processador e o campo "checksum" eh o hash (hashFNV) de tudo
+/// que vem depois do cabecalho.
+/// ###########################################################################
+
+struct CabecalhoTabela
+{
+  char magica[8];      // MAGICA_TABELA
+  uint32_t ordem;      // ORDEM_BINARIO
+  uint32_t versao;     // VERSAO_TABELA
+  uint32_t Nin;        // numero de entradas
+  uint32_t Nout;       // numero de saidas
+  uint32_t bytesLinha; // bytes de cada linha
+  uint32_t reservado;
+  uint64_t Nlinhas;    // numero de linhas (3^Nin)
+  uint64_t checksum;   // hash do restante do arquivo
+};
+
+const char MAGICA_TABELA[8] = {'C', 'I', 'R', 'C', '3', 'S', 'T', 'B'};
+const uint32_t VERSAO_TABELA = 1;
+
+// Numero de bytes de cada linha da tabela binaria de um circuito com NO saidas
+inline uint32_t bytesLinhaTabela(unsigned NO) { return (NO + 3) / 4; }
+
+// Simula o circuito para todas as entradas (como gerarTabela) e grava a tabela
+// verdade no formato binario no arquivo arq. Os trechos simulados em paralelo sao
+// gravados ao ficarem prontos, sem guardar a tabela inteira em memoria
+// Retorna true se deu tudo OK; false se deu erro (circuito invalido ou erro de gravacao,
+// que interrompe a simulacao)
+bool salvarTabelaBinaria(const Circuito &C, const std::string &arq, unsigned NThreads = 0);
+
+///
+/// CLASSE TABELA BINARIA
+///
+
+// Leitura de uma tabela verdade no formato binario: o arquivo eh mapeado em memoria
+// (ver ArquivoMapeado) e as linhas sao consultadas diretamente no arquivo
+class TabelaBinaria
+{
+private:
+  ArquivoMapeado arquivo;
+  CabecalhoTabela cab;
+  // O inicio das linhas, dentro do arquivo
+  const uint8_t *linhas;
+
+public:
+  TabelaBinaria();
+
+  // Abre o arquivo arq (fechando o anterior, se houver)
+  // Confere o cabecalho, o tamanho e o checksum (os erros sao impressos em cerr)
+  // Retorna true se deu tudo OK; false se deu erro
+  bool abrir(const std::string &arq);
+
+  // Libera o arquivo
+  void fechar();
+
+  bool aberta() const { return linhas != nullptr; }
+  unsigned getNumInputs() const { return cab.Nin; }
+  unsigned getNumOutputs() const { return cab.Nout; }
+  uint64_t getNumLinhas() const { return cab.Nlinhas; }
+  unsigned getBytesLinha() const { return cab.bytesLinha; }
+
+  // Os bytes da L-esima linha (L de 0 a NumLinhas-1)
+  const uint8_t *getLinha(uint64_t L) const { return linhas + L * cab.bytesLinha; }
+
+  // O valor da J-esima saida (J de 0 a NumOutputs-1) na L-esima linha
+  bool3S getSaida(uint64_t L, unsigned J) const
+  {
+    return bool3S((getLinha(L)[J / 4] >> (2 * (J % 4))) & 3);
+  }
+
+  // Imprime a tabela em O, no mesmo formato de gerarTabela
+  void imprimir(std::ostream &O = std::cout) const;
+};
+
+// Compara duas tabelas binarias com os mesmos numeros de entradas e de saidas:
+// imprime em O as primeiras MaxImpressas linhas diferentes (entradas, saidas de T1 e
+// saidas de T2) e o numero total de linhas diferentes, que tambem vai para Ndif
+// Retorna false (e nao compara; a mensagem vai para cerr) se as tabelas nao forem compativeis
+bool compararTabelas(const TabelaBinaria &T1, const TabelaBinaria &T2, uint64_t &Ndif,
+                     std::ostream &O = std::cout, uint64_t MaxImpressas = 20);
+
+/// ***********************
+/// Enumeracao em codigo de Gray ternario
+/// ***********************
+
+// Percorre as 3^NI linhas da tabela verdade no codigo de Gray ternario refletido:
+// de uma linha para a seguinte, exatamente uma entrada muda, e apenas de um passo
+// (UNDEF <-> FALSE ou FALSE <-> TRUE). Comeca com todas as entradas UNDEF (linha 0).
+// Usa o algoritmo sem lacos de Knuth (TAOCP 7.2.1.1, algoritmo H): cada passo
+// custa O(1), independente do numero de entradas
+class EnumeradorGray
+{
+private:
+  // Os digitos sao numerados a partir do menos significativo:
+  // o digito j corresponde aa entrada NI-1-j
+  std::vector<bool3S> entradas;
+  std::vector<int> direcao;   // +1 ou -1: sentido em que o digito j estah andando
+  std::vector<unsigned> foco; // ponteiros de foco do algoritmo H
+  std::vector<uint64_t> peso; // 3^j
+  uint64_t linha;
+
+public:
+  // Comeca a enumeracao para NI entradas (NI <= MAX_ENTRADAS_TABELA)
+  EnumeradorGray(unsigned NI);
+
+  // As entradas da linha atual
+  const std::vector<bool3S> &getEntradas() const { return entradas; }
+
+  // O numero da linha atual na ordem canonica da tabela verdade
+  uint64_t getLinha() const { return linha; }
+
+  // Passa para a proxima linha. Se houver, retorna true e faz I <- o indice
+  // (de 0 a NI-1) da entrada que mudou; se a enumeracao terminou, retorna false
+  bool proximo(unsigned &I);
+};
+
+// Maior memoria (em bytes: um por saida de cada linha) que gerarTabelaGray pode usar
+// para guardar a tabela na ordem canonica
+const uint64_t MAX_MEMORIA_TABELA_GRAY = uint64_t(1) << 30;
+
+// Simula o circuito para todas as entradas, percorrendo as linhas em codigo de Gray
+// ternario (ver EnumeradorGray) e usando simulacao incremental (Circuito::resimular):
+// como soh uma entrada muda de uma linha para a seguinte, cada linha custa apenas
+// o cone de fan-out dessa entrada
+// Se OrdemCanonica for true, guarda as saidas e imprime a tabela em O na ordem canonica,
+// identica aa de gerarTabela (para poder comparar); se for false, imprime as linhas
+// na ordem em que foram simuladas, sem guardar nada
+// Retorna false (e nao imprime nada) se o circuito for invalido ou, na ordem canonica,
+// se a tabela nao couber em MAX_MEMORIA_TABELA_GRAY
+bool gerarTabelaGray(const Circuito &C, std::ostream &O = std::cout, bool OrdemCanonica = true);
+
+#endif // _TABELA_H_
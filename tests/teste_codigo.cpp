@@ -0,0 +1,97 @@
+#include <array>
+#include <vector>
+#include "teste_comum.h"
+#include "bool3S.h"
+#include "palavra3S.h"
+#include "dsl3S.h"
+#include "circuito.h"
+#include "tabela.h"
+// Gerado na compilacao (circuito generate + circuito convert, ver CMakeLists.txt)
+#include "circuito_teste.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// TESTE DO CODIGO C++ GERADO
+/// O cabecalho circuito_teste.h eh gerado (ver codigo.h) na compilacao a partir
+/// de um circuito sintetico com lacos de realimentacao, gravado em
+/// ARQUIVO_CIRCUITO_TESTE. A funcao gerada, com bool3S e com Palavra3S, deve
+/// ter as saidas da simulacao de referencia em todas as linhas da tabela verdade.
+/// Os circuitos descritos por tipos (dsl3S.h) sao conferidos na compilacao.
+/// ###########################################################################
+
+using namespace std;
+
+constexpr unsigned NI = circuito_teste::NUM_ENTRADAS;
+constexpr unsigned NO = circuito_teste::NUM_SAIDAS;
+
+// A funcao gerada pode ser avaliada em tempo de compilacao: com todas as entradas
+// indefinidas, todas as saidas ficam indefinidas
+constexpr bool saidasIndefinidas()
+{
+  array<bool3S, NI> in_circ{};
+  for (bool3S x : circuito_teste::simular(in_circ))
+    if (x != bool3S::UNDEF)
+      return false;
+  return true;
+}
+static_assert(saidasIndefinidas(), "Saida definida com entradas indefinidas");
+
+// O multiplexador 2x1 do exemplo de dsl3S.h, com bool3S e com Palavra3S: no bit 0,
+// o seletor eh TRUE e a saida eh a entrada 1 (FALSE); no bit 1, eh FALSE e a saida
+// eh a entrada 2 (TRUE); no bit 2, eh indefinido, e a saida tambem, mesmo com as
+// duas entradas TRUE
+namespace mux
+{
+using namespace dsl3S;
+using Sel = E<0>;
+using Mux = Circuito3S<OR<AN<Sel, E<1>>, AN<NT<Sel>, E<2>>>>;
+constexpr array<bool3S, 3> in{bool3S::TRUE, bool3S::FALSE, bool3S::UNDEF};
+static_assert(Mux::NUM_SAIDAS == 1, "dsl3S: numero de saidas do Mux");
+static_assert(Mux::simular(in)[0] == bool3S::FALSE, "dsl3S: Mux com bool3S");
+constexpr array<Palavra3S, 3> in_lote{Palavra3S{0b001, 0b010}, Palavra3S{0b110, 0b001},
+                                      Palavra3S{0b111, 0b000}};
+static_assert(Mux::simular(in_lote)[0] == Palavra3S{0b010, 0b001}, "dsl3S: Mux com Palavra3S");
+} // namespace mux
+
+int main()
+{
+  Circuito C;
+  DescricaoCircuito D;
+  if (!C.ler(ARQUIVO_CIRCUITO_TESTE))
+  {
+    VERIFICAR(false, "arquivo " << ARQUIVO_CIRCUITO_TESTE << " invalido");
+    return resultadoTeste("teste_codigo");
+  }
+  C.descrever(D);
+  VERIFICAR(C.getNumInputs() == NI && C.getNumOutputs() == NO, "dimensoes do circuito gerado");
+  vector<bool3S> Ref;
+  tabelaReferencia(D, Ref);
+  uint64_t Nlinhas = Ref.size() / NO;
+
+  vector<bool3S> in_circ;
+  array<bool3S, NI> in_arr;
+  for (uint64_t L = 0; L < Nlinhas; L++)
+  {
+    linhaEntradas(NI, L, in_circ);
+    for (unsigned i = 0; i < NI; i++)
+      in_arr[i] = in_circ[i];
+    array<bool3S, NO> out_arr = circuito_teste::simular(in_arr);
+    for (unsigned j = 0; j < NO; j++)
+      VERIFICAR(out_arr[j] == Ref[L * NO + j], "codigo gerado: linha " << L << ", saida " << j + 1);
+  }
+
+  array<Palavra3S, NI> in_lote;
+  for (uint64_t L0 = 0; L0 < Nlinhas; L0 += BITS_PALAVRA3S)
+  {
+    unsigned nb = (Nlinhas - L0 < BITS_PALAVRA3S ? Nlinhas - L0 : BITS_PALAVRA3S);
+    preencherLinhas(NI, L0, nb, in_lote.data());
+    array<Palavra3S, NO> out_lote = circuito_teste::simular<Palavra3S>(in_lote);
+    for (unsigned b = 0; b < nb; b++)
+      for (unsigned j = 0; j < NO; j++)
+        VERIFICAR(getBool3S(out_lote[j], b) == Ref[(L0 + b) * NO + j],
+                  "codigo gerado (Palavra3S): linha " << L0 + b << ", saida " << j + 1);
+  }
+  return resultadoTeste("teste_codigo");
+}
@@ -0,0 +1,166 @@
+#ifndef _TESTE_COMUM_H_
+#define _TESTE_COMUM_H_
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "bool3S.h"
+#include "netlist.h"
+#include "gerador.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// FUNCOES COMUNS DOS TESTES
+/// Os testes comparam cada forma de simulacao (netlist escalar, Palavra3S,
+/// Bloco3S, codigo nativo, codigo C++ gerado, tabelas, simulacao incremental,
+/// etc.) com uma simulacao de referencia, que soh usa os operadores de bool3S
+/// e a descricao do circuito, sobre circuitos sinteticos (ver gerador.h) com e
+/// sem lacos de realimentacao.
+/// Cada teste eh um programa que retorna 0 se passou, 1 se falhou e 77 se nao
+/// pode ser executado neste sistema (ver tests/ no CMakeLists.txt).
+/// ###########################################################################
+
+// Numero de verificacoes que falharam
+inline unsigned falhas_teste = 0;
+
+// Confere a condicao Cond; se falhar, conta a falha e imprime Msg (com o arquivo e a
+// linha) em cerr. Soh as primeiras falhas sao impressas
+#define VERIFICAR(Cond, Msg)                                                              \
+  do                                                                                      \
+  {                                                                                       \
+    if (!(Cond) && falhas_teste++ < 20)                                                   \
+      std::cerr << "FALHA (" << __FILE__ << ":" << __LINE__ << "): " << Msg << std::endl; \
+  } while (false)
+
+// Imprime o resultado do teste Nome e retorna o codigo de saida do programa
+inline int resultadoTeste(const char *Nome)
+{
+  if (falhas_teste == 0)
+    std::cout << Nome << ": OK\n";
+  else
+    std::cout << Nome << ": " << falhas_teste << " falha(s)\n";
+  return (falhas_teste == 0 ? 0 : 1);
+}
+
+// Preenche D com o circuito de teste numero Semente: de 4 a 7 entradas, de 20 a
+// 300 portas, com todos os tipos de porta; 3 de cada 4 circuitos tem lacos de
+// realimentacao (com janelas pequenas, para que os lacos sejam curtos e variados)
+inline bool circuitoTeste(unsigned Semente, DescricaoCircuito &D)
+{
+  ParametrosGerador P;
+  P.Nin = 4 + Semente % 4;
+  P.Nout = 1 + Semente % 6;
+  P.Nportas = 20 + (Semente * 37) % 280;
+  P.fanin_min = 2;
+  P.fanin_max = 2 + Semente % 3;
+  P.frac_entradas = 0.3;
+  P.janela = 4 + Semente % 12;
+  P.frac_realimentacao = 0.04 * (Semente % 4);
+  P.semente = Semente;
+  return gerarCircuito(P, D);
+}
+
+// Numero de circuitos de teste usados por cada teste
+const unsigned NUM_CIRCUITOS_TESTE = 60;
+
+// As entradas da linha L da tabela verdade de um circuito com NI entradas:
+// a entrada i eh o i-esimo digito de L na base 3, a partir do mais significativo
+inline void linhaEntradas(unsigned NI, uint64_t L, std::vector<bool3S> &in_circ)
+{
+  in_circ.resize(NI);
+  for (unsigned i = NI; i-- > 0; L /= 3)
+    in_circ[i] = bool3S(L % 3);
+}
+
+// O numero da linha da tabela verdade com as entradas in_circ
+inline uint64_t numeroLinha(const std::vector<bool3S> &in_circ)
+{
+  uint64_t L = 0;
+  for (bool3S x : in_circ)
+    L = 3 * L + uint64_t(x);
+  return L;
+}
+
+// Simulacao de referencia, direto da descricao D (sem a netlist): as portas comecam
+// UNDEF e sao todas reavaliadas, na ordem das ids, ate que nenhuma mude. Como as
+// portas sao monotonas (os valores soh passam de UNDEF a definidos), o resultado eh o
+// menor ponto fixo, o mesmo calculado pela netlist
+inline void simularReferencia(const DescricaoCircuito &D, const std::vector<bool3S> &in_circ,
+                              std::vector<bool3S> &out_circ)
+{
+  unsigned NP = D.tipos.size();
+  std::vector<bool3S> porta(NP + 1, bool3S::UNDEF);
+  auto valor = [&](int Id)
+  { return (Id < 0 ? in_circ[-Id - 1] : porta[Id]); };
+
+  bool mudou = true;
+  while (mudou)
+  {
+    mudou = false;
+    for (unsigned i = 0; i < NP; i++)
+    {
+      TipoPorta T = D.tipos[i];
+      bool3S v = valor(D.id_in[D.inicio[i]]);
+      for (uint32_t j = D.inicio[i] + 1; j < D.inicio[i + 1]; j++)
+      {
+        if (T == TipoPorta::AN || T == TipoPorta::NA)
+          v = v & valor(D.id_in[j]);
+        else if (T == TipoPorta::OR || T == TipoPorta::NO)
+          v = v | valor(D.id_in[j]);
+        else
+          v = v ^ valor(D.id_in[j]);
+      }
+      if (T == TipoPorta::NT || T == TipoPorta::NA || T == TipoPorta::NO || T == TipoPorta::NX)
+        v = ~v;
+      if (v != porta[i + 1])
+      {
+        porta[i + 1] = v;
+        mudou = true;
+      }
+    }
+  }
+
+  out_circ.resize(D.id_out.size());
+  for (unsigned j = 0; j < D.id_out.size(); j++)
+    out_circ[j] = valor(D.id_out[j]);
+}
+
+// As saidas de referencia de todas as linhas da tabela verdade do circuito D:
+// as saidas da linha L estao em Tabela[L*NO] .. Tabela[L*NO+NO-1]
+inline void tabelaReferencia(const DescricaoCircuito &D, std::vector<bool3S> &Tabela)
+{
+  unsigned NO = D.id_out.size();
+  uint64_t Nlinhas = 1;
+  for (unsigned i = 0; i < D.Nin; i++)
+    Nlinhas *= 3;
+  std::vector<bool3S> in_circ, out_circ;
+  Tabela.resize(Nlinhas * NO);
+  for (uint64_t L = 0; L < Nlinhas; L++)
+  {
+    linhaEntradas(D.Nin, L, in_circ);
+    simularReferencia(D, in_circ, out_circ);
+    for (unsigned j = 0; j < NO; j++)
+      Tabela[L * NO + j] = out_circ[j];
+  }
+}
+
+// Gerador pseudoaleatorio simples (xorshift) para os testes
+struct AleatorioTeste
+{
+  uint64_t x;
+  explicit AleatorioTeste(uint64_t Semente) : x(0x9e3779b97f4a7c15ULL * (Semente + 1)) {}
+  uint64_t operator()()
+  {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return x;
+  }
+  // Um numero de 0 a N-1
+  unsigned ateh(unsigned N) { return unsigned((*this)() % N); }
+};
+
+#endif // _TESTE_COMUM_H_
@@ -0,0 +1,88 @@
+#include <string>
+#include <vector>
+#include "teste_comum.h"
+#include "circuito.h"
+#include "nativo.h"
+#include "tabela.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// TESTE DA SIMULACAO NATIVA
+/// Para alguns circuitos de teste, compila a simulacao nativa (ver nativo.h) e
+/// compara as duas funcoes compiladas (bool3S e Palavra3S) com a simulacao de
+/// referencia em todas as linhas da tabela verdade. Carregar o mesmo circuito
+/// de novo deve usar o cache, sem compilar.
+/// Argumento: o diretorio do cache (padrao: o de SimuladorNativo); o compilador
+/// C eh o da variavel CC. Retorna 77 (teste ignorado) em sistemas sem suporte.
+/// ###########################################################################
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+#ifndef NATIVO_DISPONIVEL
+  (void)argc;
+  (void)argv;
+  cout << "teste_nativo: simulacao nativa nao disponivel neste sistema\n";
+  return 77;
+#else
+  string cache = (argc > 1 ? string(argv[1]) + "/cache_nativo" : "");
+
+  for (unsigned s = 1; s <= NUM_CIRCUITOS_TESTE; s += 10)
+  {
+    DescricaoCircuito D;
+    Circuito C;
+    if (!circuitoTeste(s, D) || !C.definir(D))
+    {
+      VERIFICAR(false, "circuito de teste " << s << " invalido");
+      continue;
+    }
+    unsigned NI = C.getNumInputs(), NO = C.getNumOutputs();
+    vector<bool3S> Ref;
+    tabelaReferencia(D, Ref);
+
+    SimuladorNativo S;
+    if (!S.carregar(C, cache))
+    {
+      VERIFICAR(false, "carregar falhou (circuito " << s << ")");
+      continue;
+    }
+    uint64_t Nlinhas = Ref.size() / NO;
+    vector<bool3S> in_circ, out_circ(NO);
+    for (uint64_t L = 0; L < Nlinhas; L++)
+    {
+      linhaEntradas(NI, L, in_circ);
+      S.simular(in_circ.data(), out_circ.data());
+      for (unsigned j = 0; j < NO; j++)
+        VERIFICAR(out_circ[j] == Ref[L * NO + j], "nativo: linha " << L << ", saida " << j + 1);
+    }
+
+    vector<Palavra3S> in_lote(NI), out_lote(NO);
+    for (uint64_t L0 = 0; L0 < Nlinhas; L0 += BITS_PALAVRA3S)
+    {
+      unsigned nb = (Nlinhas - L0 < BITS_PALAVRA3S ? Nlinhas - L0 : BITS_PALAVRA3S);
+      preencherLinhas(NI, L0, nb, in_lote.data());
+      S.simular(in_lote.data(), out_lote.data());
+      for (unsigned b = 0; b < nb; b++)
+        for (unsigned j = 0; j < NO; j++)
+          VERIFICAR(getBool3S(out_lote[j], b) == Ref[(L0 + b) * NO + j],
+                    "nativo (Palavra3S): linha " << L0 + b << ", saida " << j + 1);
+    }
+
+    // A segunda carga vem do cache
+    SimuladorNativo S2;
+    VERIFICAR(S2.carregar(C, cache) && !S2.compilado() && S2.getChave() == S.getChave(),
+              "circuito " << s << " nao foi carregado do cache");
+  }
+
+  // Sem biblioteca carregada, simular nao faz nada
+  SimuladorNativo vazio;
+  bool3S x = bool3S::TRUE;
+  vazio.simular(&x, &x);
+  VERIFICAR(!vazio.carregado() && x == bool3S::TRUE, "simular sem biblioteca carregada");
+
+  return resultadoTeste("teste_nativo");
+#endif
+}
@@ -0,0 +1,182 @@
+#include <vector>
+#include "teste_comum.h"
+#include "circuito.h"
+#include "otimizador.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// TESTE DA OTIMIZACAO E DA ESPECIALIZACAO DE CIRCUITOS
+/// otimizarCircuito: o circuito otimizado deve ter as mesmas saidas da simulacao
+/// de referencia em todas as linhas da tabela verdade. Aos circuitos de teste sao
+/// acrescentadas portas duplicadas (com as entradas em outra ordem), NOT de NOT e
+/// portas com entradas repetidas, para exercitar todas as simplificacoes. Uma
+/// porta igual a uma porta de laco tambem deve ser eliminada.
+/// especializarCircuito: para entradas fixas aleatorias, o circuito especializado
+/// deve ter as saidas da referencia para todos os valores das entradas livres.
+/// ###########################################################################
+
+using namespace std;
+
+// Acrescenta a D portas redundantes, e liga algumas saidas a elas
+static void acrescentarRedundancias(DescricaoCircuito &D, AleatorioTeste &A)
+{
+  unsigned NP = D.tipos.size();
+  for (unsigned r = 0; r < NP / 2; r++)
+  {
+    unsigned i = A.ateh(D.tipos.size());
+    int nova = D.tipos.size() + 1;
+    switch (A.ateh(3))
+    {
+    case 0:
+    {
+      // A porta i, com as entradas em ordem inversa
+      vector<int> in(D.id_in.begin() + D.inicio[i], D.id_in.begin() + D.inicio[i + 1]);
+      D.tipos.push_back(D.tipos[i]);
+      D.id_in.insert(D.id_in.end(), in.rbegin(), in.rend());
+      break;
+    }
+    case 1:
+      // NOT da porta i
+      D.tipos.push_back(TipoPorta::NT);
+      D.id_in.push_back(i + 1);
+      break;
+    default:
+      // Porta com uma entrada repetida
+      int x = (A.ateh(2) ? int(i + 1) : -int(1 + A.ateh(D.Nin)));
+      D.tipos.push_back(TipoPorta(1 + A.ateh(6)));
+      D.id_in.push_back(x);
+      D.id_in.push_back(x);
+      if (A.ateh(2))
+        D.id_in.push_back(-1);
+    }
+    D.inicio.push_back(D.id_in.size());
+    if (A.ateh(2))
+      D.id_out[A.ateh(D.id_out.size())] = nova;
+  }
+}
+
+static void testarOtimizacao(unsigned Semente)
+{
+  DescricaoCircuito D, Dotim;
+  Circuito C, otimizado;
+  AleatorioTeste A(Semente);
+  if (!circuitoTeste(Semente, D))
+  {
+    VERIFICAR(false, "circuito de teste " << Semente << " invalido");
+    return;
+  }
+  acrescentarRedundancias(D, A);
+  EstatisticasOtimizacao E;
+  if (!C.definir(D) || !otimizarCircuito(C, otimizado, &E))
+  {
+    VERIFICAR(false, "otimizarCircuito falhou (circuito " << Semente << ")");
+    return;
+  }
+  VERIFICAR(E.portas_depois <= E.portas_antes && E.portas_depois == otimizado.getNumPorts(),
+            "estatisticas da otimizacao (circuito " << Semente << ")");
+  VERIFICAR(otimizado.getNumInputs() == C.getNumInputs() && otimizado.getNumOutputs() == C.getNumOutputs(),
+            "dimensoes do circuito otimizado");
+
+  vector<bool3S> Ref, Rotim;
+  otimizado.descrever(Dotim);
+  tabelaReferencia(D, Ref);
+  tabelaReferencia(Dotim, Rotim);
+  VERIFICAR(Rotim == Ref, "circuito otimizado nao eh equivalente (circuito " << Semente << ")");
+
+  // Otimizar de novo nao aumenta o circuito
+  Circuito de_novo;
+  VERIFICAR(otimizarCircuito(otimizado, de_novo) && de_novo.getNumPorts() <= otimizado.getNumPorts(),
+            "segunda otimizacao aumentou o circuito");
+}
+
+// Porta 3 igual a porta 1, que estah em um laco e eh simulada antes da sua entrada 2
+static void testarPortaIgualEmLaco()
+{
+  DescricaoCircuito D, Dotim;
+  D.Nin = 2;
+  D.tipos = {TipoPorta::AN, TipoPorta::OR, TipoPorta::AN};
+  D.inicio = {0, 2, 5, 7};
+  D.id_in = {-1, 2, -2, 1, 1, 2, -1};
+  D.id_out = {1, 3};
+  Circuito C, otimizado;
+  EstatisticasOtimizacao E;
+  if (!C.definir(D) || !otimizarCircuito(C, otimizado, &E))
+  {
+    VERIFICAR(false, "otimizarCircuito falhou (porta igual em laco)");
+    return;
+  }
+  VERIFICAR(E.duplicadas == 1 && otimizado.getNumPorts() == 2,
+            "porta igual em laco: " << E.duplicadas << " duplicadas, " << otimizado.getNumPorts() << " portas");
+  vector<bool3S> Ref, Rotim;
+  otimizado.descrever(Dotim);
+  tabelaReferencia(D, Ref);
+  tabelaReferencia(Dotim, Rotim);
+  VERIFICAR(Rotim == Ref, "circuito otimizado nao eh equivalente (porta igual em laco)");
+}
+
+static void testarEspecializacao(unsigned Semente)
+{
+  DescricaoCircuito D, Desp;
+  Circuito C, especializado;
+  AleatorioTeste A(Semente);
+  if (!circuitoTeste(Semente, D) || !C.definir(D))
+  {
+    VERIFICAR(false, "circuito de teste " << Semente << " invalido");
+    return;
+  }
+  unsigned NI = C.getNumInputs(), NO = C.getNumOutputs();
+
+  // Em alguns circuitos, todas as entradas fixas
+  vector<bool3S> fixas(NI);
+  for (bool3S &x : fixas)
+    x = bool3S(Semente % 5 == 0 ? 1 + A.ateh(2) : A.ateh(3));
+  vector<int> entradas;
+  if (!especializarCircuito(C, fixas, especializado, entradas))
+  {
+    VERIFICAR(false, "especializarCircuito falhou (circuito " << Semente << ")");
+    return;
+  }
+  VERIFICAR(especializado.getNumInputs() == entradas.size() && especializado.getNumOutputs() == NO,
+            "dimensoes do circuito especializado");
+  especializado.descrever(Desp);
+
+  // Todas as combinacoes das entradas livres (as do circuito especializado que nao
+  // sao fixas); as fixas recebem o seu valor
+  vector<unsigned> livres;
+  for (unsigned k = 0; k < entradas.size(); k++)
+    if (fixas[-entradas[k] - 1] == bool3S::UNDEF)
+      livres.push_back(k);
+  uint64_t Ncombinacoes = 1;
+  for (size_t k = 0; k < livres.size(); k++)
+    Ncombinacoes *= 3;
+
+  vector<bool3S> in_esp(entradas.size()), in_circ, out_esp, out_ref;
+  for (uint64_t L = 0; L < Ncombinacoes; L++)
+  {
+    linhaEntradas(livres.size(), L, in_circ);
+    for (unsigned k = 0; k < entradas.size(); k++)
+      in_esp[k] = fixas[-entradas[k] - 1];
+    for (size_t k = 0; k < livres.size(); k++)
+      in_esp[livres[k]] = in_circ[k];
+    in_circ = fixas;
+    for (unsigned k = 0; k < entradas.size(); k++)
+      in_circ[-entradas[k] - 1] = in_esp[k];
+    simularReferencia(D, in_circ, out_ref);
+    simularReferencia(Desp, in_esp, out_esp);
+    VERIFICAR(out_esp == out_ref, "circuito especializado nao eh equivalente (circuito " << Semente
+                                                                                   << ", combinacao " << L << ")");
+  }
+}
+
+int main()
+{
+  testarPortaIgualEmLaco();
+  for (unsigned s = 1; s <= NUM_CIRCUITOS_TESTE; s++)
+  {
+    testarOtimizacao(s);
+    testarEspecializacao(s);
+  }
+  return resultadoTeste("teste_otimizador");
+}
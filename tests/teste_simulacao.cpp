@@ -0,0 +1,166 @@
+#include <vector>
+#include "teste_comum.h"
+#include "circuito.h"
+#include "netlist.h"
+#include "tabela.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// TESTE DAS FORMAS DE SIMULACAO DA NETLIST
+/// Para cada circuito de teste e cada linha da tabela verdade, compara com a
+/// simulacao de referencia: Circuito::simular (com e sem contexto), a simulacao
+/// de 64 vetores (Palavra3S), a de 512 vetores (Bloco3S, com o kernel vetorial
+/// escolhido em simd3S.h) e a simulacao incremental (Circuito::resimular), em
+/// codigo de Gray e com mudancas aleatorias de varias entradas de uma vez.
+/// Confere tambem as reducoes n-arias de bool3S (8 valores de cada vez) com a
+/// aplicacao dos operadores um valor por vez.
+/// ###########################################################################
+
+using namespace std;
+
+// Circuito::simular, um vetor de cada vez (com contexto e no proprio circuito)
+static void testarEscalar(const Circuito &C, const vector<bool3S> &Ref)
+{
+  unsigned NI = C.getNumInputs(), NO = C.getNumOutputs();
+  Circuito copia(C);
+  ContextoSimulacao Ctx;
+  vector<bool3S> in_circ;
+  for (uint64_t L = 0; L < Ref.size() / NO; L++)
+  {
+    linhaEntradas(NI, L, in_circ);
+    VERIFICAR(C.simular(in_circ, Ctx) && copia.simular(in_circ), "simulacao falhou");
+    for (unsigned j = 0; j < NO; j++)
+    {
+      VERIFICAR(Ctx.getOutput(j + 1) == Ref[L * NO + j], "simular(Ctx): linha " << L << ", saida " << j + 1);
+      VERIFICAR(copia.getOutput(j + 1) == Ref[L * NO + j], "simular(): linha " << L << ", saida " << j + 1);
+    }
+  }
+}
+
+// Circuito::simular com 64 vetores (Palavra3S)
+static void testarPalavras(const Circuito &C, const vector<bool3S> &Ref)
+{
+  unsigned NI = C.getNumInputs(), NO = C.getNumOutputs();
+  uint64_t Nlinhas = Ref.size() / NO;
+  vector<Palavra3S> in_lote(NI), out_lote(NO);
+  for (uint64_t L0 = 0; L0 < Nlinhas; L0 += BITS_PALAVRA3S)
+  {
+    unsigned nb = (Nlinhas - L0 < BITS_PALAVRA3S ? Nlinhas - L0 : BITS_PALAVRA3S);
+    preencherLinhas(NI, L0, nb, in_lote.data());
+    VERIFICAR(C.simular(in_lote, out_lote), "simulacao de Palavra3S falhou");
+    for (unsigned b = 0; b < nb; b++)
+      for (unsigned j = 0; j < NO; j++)
+        VERIFICAR(getBool3S(out_lote[j], b) == Ref[(L0 + b) * NO + j],
+                  "Palavra3S: linha " << L0 + b << ", saida " << j + 1);
+  }
+}
+
+// Netlist::simular com 512 vetores (Bloco3S)
+static void testarBlocos(const Circuito &C, const vector<bool3S> &Ref)
+{
+  const Netlist &N = C.getNetlist();
+  unsigned NI = N.getNumInputs(), NO = N.getNumOutputs();
+  uint64_t Nlinhas = Ref.size() / NO;
+  vector<Bloco3S> in_circ(NI), valores(N.getNumSinais());
+  for (uint64_t L0 = 0; L0 < Nlinhas; L0 += BITS_BLOCO3S)
+  {
+    unsigned nb = (Nlinhas - L0 < BITS_BLOCO3S ? Nlinhas - L0 : BITS_BLOCO3S);
+    preencherLinhas(NI, L0, nb, in_circ.data());
+    N.simular(in_circ.data(), valores.data());
+    for (unsigned b = 0; b < nb; b++)
+      for (unsigned j = 0; j < NO; j++)
+        VERIFICAR(getBool3S(valores[N.getSaida(j)], b) == Ref[(L0 + b) * NO + j],
+                  "Bloco3S: linha " << L0 + b << ", saida " << j + 1);
+  }
+}
+
+// Circuito::resimular: todas as linhas em codigo de Gray (uma entrada muda de cada
+// vez) e depois mudancas aleatorias de ateh 3 entradas de uma vez
+static void testarIncremental(const Circuito &C, const vector<bool3S> &Ref, unsigned Semente)
+{
+  unsigned NI = C.getNumInputs(), NO = C.getNumOutputs();
+  ContextoSimulacao Ctx;
+  auto conferir = [&](const vector<bool3S> &in_circ, const char *Modo)
+  {
+    uint64_t L = numeroLinha(in_circ);
+    for (unsigned j = 0; j < NO; j++)
+      VERIFICAR(Ctx.getOutput(j + 1) == Ref[L * NO + j],
+                "resimular (" << Modo << "): linha " << L << ", saida " << j + 1);
+  };
+
+  EnumeradorGray G(NI);
+  vector<int> alterada(1);
+  unsigned I;
+  C.simular(G.getEntradas(), Ctx);
+  conferir(G.getEntradas(), "Gray");
+  while (G.proximo(I))
+  {
+    alterada[0] = -int(I) - 1;
+    VERIFICAR(C.resimular(G.getEntradas(), alterada, Ctx), "resimular falhou");
+    conferir(G.getEntradas(), "Gray");
+  }
+
+  AleatorioTeste A(Semente);
+  vector<bool3S> in_circ = G.getEntradas();
+  vector<int> ids;
+  for (unsigned passo = 0; passo < 500; passo++)
+  {
+    ids.clear();
+    for (unsigned k = 1 + A.ateh(3); k > 0; k--)
+    {
+      unsigned i = A.ateh(NI);
+      in_circ[i] = bool3S(A.ateh(3)); // pode ficar igual: tambem deve funcionar
+      ids.push_back(-int(i) - 1);
+    }
+    VERIFICAR(C.resimular(in_circ, ids, Ctx), "resimular falhou");
+    conferir(in_circ, "aleatorio");
+  }
+}
+
+// reduzirAND, reduzirOR e reduzirXOR, para arrays de ateh 40 valores (varios grupos
+// de 8 e o resto), com valores uniformes ou com um soh valor raro
+static void testarReducoes()
+{
+  AleatorioTeste A(12345);
+  bool3S V[40];
+  for (unsigned teste = 0; teste < 20000; teste++)
+  {
+    unsigned N = 1 + A.ateh(40), raro = A.ateh(4);
+    for (unsigned i = 0; i < N; i++)
+      V[i] = (raro == 3 || A.ateh(20) == 0 ? bool3S(A.ateh(3)) : bool3S(raro == 0 ? 1 + A.ateh(2) : raro));
+    bool3S E = V[0], O = V[0], X = V[0];
+    for (unsigned i = 1; i < N; i++)
+    {
+      E &= V[i];
+      O |= V[i];
+      X ^= V[i];
+    }
+    VERIFICAR(reduzirAND(V, N) == E, "reduzirAND: " << N << " valores");
+    VERIFICAR(reduzirOR(V, N) == O, "reduzirOR: " << N << " valores");
+    VERIFICAR(reduzirXOR(V, N) == X, "reduzirXOR: " << N << " valores");
+  }
+}
+
+int main()
+{
+  testarReducoes();
+  for (unsigned s = 1; s <= NUM_CIRCUITOS_TESTE; s++)
+  {
+    DescricaoCircuito D;
+    Circuito C;
+    if (!circuitoTeste(s, D) || !C.definir(D))
+    {
+      VERIFICAR(false, "circuito de teste " << s << " invalido");
+      continue;
+    }
+    vector<bool3S> Ref;
+    tabelaReferencia(D, Ref);
+    testarEscalar(C, Ref);
+    testarPalavras(C, Ref);
+    testarBlocos(C, Ref);
+    testarIncremental(C, Ref, s);
+  }
+  return resultadoTeste("teste_simulacao");
+}
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "teste_comum.h"
+#include "circuito.h"
+#include "tabela.h"
+
+// Bernardo Fonseca Andrade de Lima
+// Francisco de Assis Vilela Neto
+
+/// ###########################################################################
+/// TESTE DAS TABELAS VERDADE
+/// Para cada circuito de teste: a tabela de gerarTabela (com 1 e com 4 threads)
+/// deve ter as saidas da simulacao de referencia; a de gerarTabelaGray deve ser
+/// identica a ela (na ordem canonica) ou ter as mesmas linhas (na ordem de Gray);
+/// e a tabela binaria (salvarTabelaBinaria) deve ter as mesmas saidas.
+/// simularTabela deve parar quando a escrita falha e repassar as excecoes de
+/// Formatar e de Escrever, depois de esperar as threads.
+/// Argumento: o diretorio dos arquivos temporarios (padrao: o atual).
+/// ###########################################################################
+
+using namespace std;
+
+// As linhas do texto T, sem o cabecalho, em ordem alfabetica
+static vector<string> linhasOrdenadas(const string &T)
+{
+  vector<string> linhas;
+  istringstream I(T);
+  string linha;
+  getline(I, linha);
+  while (getline(I, linha))
+    linhas.push_back(linha);
+  sort(linhas.begin(), linhas.end());
+  return linhas;
+}
+
+// Confere a tabela em texto T (formato de gerarTabela) com a referencia
+static void conferirTexto(const string &T, unsigned NI, unsigned NO, const vector<bool3S> &Ref)
+{
+  istringstream I(T);
+  string cabecalho;
+  getline(I, cabecalho);
+  VERIFICAR(cabecalho == "ENTRADAS\tSAIDAS", "cabecalho da tabela: " << cabecalho);
+  vector<bool3S> in_circ(NI);
+  bool3S x;
+  for (uint64_t L = 0; L < Ref.size() / NO; L++)
+  {
+    linhaEntradas(NI, L, in_circ);
+    for (unsigned i = 0; i < NI; i++)
+      VERIFICAR((I >> x) && x == in_circ[i], "tabela: entradas da linha " << L);
+    for (unsigned j = 0; j < NO; j++)
+      VERIFICAR((I >> x) && x == Ref[L * NO + j], "tabela: linha " << L << ", saida " << j + 1);
+  }
+  VERIFICAR(!(I >> x), "tabela com linhas demais");
+}
+
+// Um circuito com 12 entradas (65 trechos da tabela): interrompe simularTabela com
+// uma falha de escrita e com excecoes, com 1 e com 4 threads
+static void testarInterrupcao()
+{
+  DescricaoCircuito D;
+  D.Nin = 12;
+  D.tipos = {TipoPorta::AN};
+  D.inicio = {0, 12};
+  for (int i = 1; i <= 12; i++)
+    D.id_in.push_back(-i);
+  D.id_out = {1};
+  Circuito C;
+  if (!C.definir(D))
+  {
+    VERIFICAR(false, "circuito de 12 entradas invalido");
+    return;
+  }
+  const Netlist &N = C.getNetlist();
+  auto nada = [](uint64_t, unsigned, const Bloco3S *, const Bloco3S *, string &) {};
+
+  for (unsigned NThreads : {1u, 4u})
+  {
+    unsigned escritas = 0;
+    bool ok = simularTabela(N, NThreads, nada, [&](const string &) { return ++escritas < 3; });
+    VERIFICAR(!ok && escritas == 3, "falha de escrita: " << escritas << " escritas (" << NThreads << " threads)");
+
+    bool capturada = false;
+    try
+    {
+      simularTabela(N, NThreads,
+                    [](uint64_t L, unsigned, const Bloco3S *, const Bloco3S *, string &)
+                    {
+                      if (L >= 10 * LINHAS_TRECHO_TABELA)
+                        throw runtime_error("Formatar");
+                    },
+                    [](const string &) { return true; });
+    }
+    catch (const runtime_error &)
+    {
+      capturada = true;
+    }
+    VERIFICAR(capturada, "excecao de Formatar nao repassada (" << NThreads << " threads)");
+
+    capturada = false;
+    escritas = 0;
+    try
+    {
+      simularTabela(N, NThreads, nada,
+                    [&](const string &)
+                    {
+                      if (++escritas == 5)
+                        throw runtime_error("Escrever");
+                      return true;
+                    });
+    }
+    catch (const runtime_error &)
+    {
+      capturada = true;
+    }
+    VERIFICAR(capturada && escritas == 5, "excecao de Escrever nao repassada (" << NThreads << " threads)");
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  string dir = (argc > 1 ? argv[1] : ".");
+  string arq_tab = dir + "/teste_tabela.tb3s";
+
+  for (unsigned s = 1; s <= NUM_CIRCUITOS_TESTE; s += 3)
+  {
+    DescricaoCircuito D;
+    Circuito C;
+    if (!circuitoTeste(s, D) || !C.definir(D))
+    {
+      VERIFICAR(false, "circuito de teste " << s << " invalido");
+      continue;
+    }
+    unsigned NI = C.getNumInputs(), NO = C.getNumOutputs();
+    vector<bool3S> Ref;
+    tabelaReferencia(D, Ref);
+
+    ostringstream t1, t4, gray, ordem_gray;
+    VERIFICAR(gerarTabela(C, t1, 1) && gerarTabela(C, t4, 4), "gerarTabela falhou");
+    VERIFICAR(gerarTabelaGray(C, gray, true) && gerarTabelaGray(C, ordem_gray, false),
+              "gerarTabelaGray falhou");
+    conferirTexto(t1.str(), NI, NO, Ref);
+    VERIFICAR(t4.str() == t1.str(), "gerarTabela com 4 threads difere (circuito " << s << ")");
+    VERIFICAR(gray.str() == t1.str(), "gerarTabelaGray difere (circuito " << s << ")");
+    VERIFICAR(linhasOrdenadas(ordem_gray.str()) == linhasOrdenadas(t1.str()),
+              "gerarTabelaGray na ordem de Gray difere (circuito " << s << ")");
+
+    TabelaBinaria T;
+    if (!salvarTabelaBinaria(C, arq_tab, 2) || !T.abrir(arq_tab))
+    {
+      VERIFICAR(false, "tabela binaria falhou: " << arq_tab);
+      continue;
+    }
+    VERIFICAR(T.getNumLinhas() == Ref.size() / NO && T.getNumOutputs() == NO, "tabela binaria: dimensoes");
+    for (uint64_t L = 0; L < T.getNumLinhas(); L++)
+      for (unsigned j = 0; j < NO; j++)
+        VERIFICAR(T.getSaida(L, j) == Ref[L * NO + j], "tabela binaria: linha " << L << ", saida " << j + 1);
+    T.fechar();
+  }
+  remove(arq_tab.c_str());
+  testarInterrupcao();
+  return resultadoTeste("teste_tabela");
+}